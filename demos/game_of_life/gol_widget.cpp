@@ -46,6 +46,7 @@ namespace gol {
 GoL_widget::GoL_widget()
 {
     *this | ox::pipe::strong_focus();
+    this->enable_raw_mouse_input();
     this->set_rules("B3/S23");
 }
 
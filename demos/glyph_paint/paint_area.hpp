@@ -24,7 +24,11 @@ class Paint_area : public ox::Widget {
     sl::Signal<void()> erase_disabled;
 
    public:
-    Paint_area() { *this | ox::pipe::strong_focus(); }
+    Paint_area()
+    {
+        *this | ox::pipe::strong_focus();
+        this->enable_raw_mouse_input();
+    }
 
    public:
     void set_glyph(ox::Glyph g)
@@ -5,8 +5,11 @@
 
 namespace ox {
 
-/// Multi-byte string to char32_t string conversion.
-/** Depends on the currently set clocale to transform the bytes. */
+/// UTF-8 string to char32_t string conversion.
+/** Locale independent. Each invalid byte sequence, overlong encoding,
+ *  surrogate or truncated sequence is decoded as a single U+FFFD, then
+ *  decoding resumes at the next byte that could start a sequence. Runs of
+ *  ASCII are converted 16 bytes at a time where SSE2 is available. */
 [[nodiscard]] auto mb_to_u32(std::string_view sv) -> std::u32string;
 
 }  // namespace ox
@@ -0,0 +1,70 @@
+#ifndef TERMOX_COMMON_MPSC_QUEUE_HPP
+#define TERMOX_COMMON_MPSC_QUEUE_HPP
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace ox {
+
+/// Unbounded FIFO queue that any number of threads push to and one pops from.
+/** Lock-free, a push() is one allocation and one atomic exchange. A pop() can
+ *  miss a value whose push() has not finished yet, it is returned by a later
+ *  pop(). Values pushed by a single thread are popped in push order. */
+template <typename T>
+class Mpsc_queue {
+   public:
+    Mpsc_queue() : head_{new Node}, tail_{head_.load()} {}
+
+    Mpsc_queue(Mpsc_queue const&) = delete;
+    Mpsc_queue(Mpsc_queue&&)      = delete;
+    Mpsc_queue& operator=(Mpsc_queue const&) = delete;
+    Mpsc_queue& operator=(Mpsc_queue&&) = delete;
+
+    ~Mpsc_queue()
+    {
+        while (tail_ != nullptr) {
+            auto* const next = tail_->next.load(std::memory_order_relaxed);
+            delete tail_;
+            tail_ = next;
+        }
+    }
+
+   public:
+    /// Append \p value to the queue, safe to call from any thread.
+    void push(T value)
+    {
+        auto* const node = new Node{std::move(value)};
+        auto* const prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /// Remove and return the oldest value, or std::nullopt if none.
+    /** Must only be called from one thread at a time. */
+    [[nodiscard]] auto pop() -> std::optional<T>
+    {
+        auto* const next = tail_->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return std::nullopt;
+        auto result = std::move(next->value);
+        next->value.reset();
+        delete tail_;
+        tail_ = next;
+        return result;
+    }
+
+   private:
+    // tail_ points to a Node whose value has already been popped.
+    struct Node {
+        Node() = default;
+        explicit Node(T v) : value{std::move(v)} {}
+
+        std::optional<T> value;
+        std::atomic<Node*> next = nullptr;
+    };
+
+    std::atomic<Node*> head_;
+    Node* tail_;
+};
+
+}  // namespace ox
+#endif  // TERMOX_COMMON_MPSC_QUEUE_HPP
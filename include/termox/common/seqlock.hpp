@@ -0,0 +1,67 @@
+#ifndef TERMOX_COMMON_SEQLOCK_HPP
+#define TERMOX_COMMON_SEQLOCK_HPP
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ox {
+
+/// Holds a T that one thread writes and any number of threads read.
+/** Readers never block the writer and take no lock, they retry if a store()
+ *  happened during the copy. The value is held as an array of atomic words,
+ *  so there is no data race even on a retried read. */
+template <typename T>
+class Seqlock {
+   public:
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(std::is_default_constructible_v<T>);
+
+   public:
+    /// Set the value, must only be called from one thread at a time.
+    void store(T const& value)
+    {
+        auto words = std::array<Word_t, word_count>{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        auto const sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (auto i = std::size_t{0}; i < word_count; ++i)
+            words_[i].store(words[i], std::memory_order_relaxed);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /// Return a copy of the value from the most recent complete store().
+    [[nodiscard]] auto load() const -> T
+    {
+        auto words = std::array<Word_t, word_count>{};
+        while (true) {
+            auto const before = sequence_.load(std::memory_order_acquire);
+            if (before % 2 != 0)
+                continue;
+            for (auto i = std::size_t{0}; i < word_count; ++i)
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before)
+                break;
+        }
+        auto result = T{};
+        std::memcpy(static_cast<void*>(&result), words.data(), sizeof(T));
+        return result;
+    }
+
+   private:
+    using Word_t = std::uint64_t;
+
+    static auto constexpr word_count =
+        (sizeof(T) + sizeof(Word_t) - 1) / sizeof(Word_t);
+
+    std::atomic<std::uint64_t> sequence_{0};
+    std::array<std::atomic<Word_t>, word_count> words_ = {};
+};
+
+}  // namespace ox
+#endif  // TERMOX_COMMON_SEQLOCK_HPP
@@ -0,0 +1,64 @@
+#ifndef TERMOX_COMMON_THREAD_POOL_HPP
+#define TERMOX_COMMON_THREAD_POOL_HPP
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <termox/common/lockable.hpp>
+
+namespace ox {
+
+/// Fixed set of worker threads that run batches of jobs in parallel.
+/** The thread calling run() works on the batch alongside the workers. */
+class Thread_pool : private Lockable<std::mutex> {
+   public:
+    using Job_t = std::function<void(std::size_t)>;
+
+   public:
+    /// Start \p worker_count threads, with zero every batch runs on the caller.
+    explicit Thread_pool(std::size_t worker_count);
+
+    Thread_pool(Thread_pool const&) = delete;
+    Thread_pool(Thread_pool&&)      = delete;
+    Thread_pool& operator=(Thread_pool const&) = delete;
+    Thread_pool& operator=(Thread_pool&&) = delete;
+
+    /// Sends exit signal and waits for the worker threads to exit.
+    ~Thread_pool();
+
+   public:
+    /// Call \p job with each index in [0, count), return once all have run.
+    /** Indices are handed out to threads in increasing order, but may run
+     *  concurrently and finish in any order. Not reentrant. */
+    void run(std::size_t count, Job_t const& job);
+
+    /// Return the number of threads started by the constructor.
+    [[nodiscard]] auto worker_count() const -> std::size_t;
+
+   private:
+    std::vector<std::thread> workers_;
+    std::condition_variable batch_ready_;
+    std::condition_variable batch_done_;
+
+    // Current batch, written under the lock before batch_ready_ is notified.
+    Job_t const* job_  = nullptr;
+    std::size_t count_ = 0;
+    std::atomic<std::size_t> next_index_ = 0;
+    std::size_t generation_              = 0;
+    std::size_t busy_workers_            = 0;
+    bool exit_                           = false;
+
+   private:
+    /// Wait for batches and work on each until exit.
+    void loop_function();
+
+    /// Run jobs from the current batch until every index is taken.
+    void work();
+};
+
+}  // namespace ox
+#endif  // TERMOX_COMMON_THREAD_POOL_HPP
@@ -1,16 +1,60 @@
 #ifndef TERMOX_COMMON_U32_TO_MB_HPP
 #define TERMOX_COMMON_U32_TO_MB_HPP
+#include <cstddef>
 #include <string>
 #include <string_view>
 
 namespace ox {
 
-/// char32_t to Multi-byte char conversion.
-/** Depends on the currently set clocale to transform the bytes. */
+/// Return the number of bytes u32_to_utf8() writes for \p c, in [1, 4].
+[[nodiscard]] constexpr auto utf8_length(char32_t c) -> std::size_t
+{
+    if (c < 0x80)
+        return 1;
+    if (c < 0x800)
+        return 2;
+    if (c < 0x10000 || c > 0x10FFFF)  // Invalid is written as U+FFFD.
+        return 3;
+    return 4;
+}
+
+/// Write the UTF-8 encoding of \p c to \p out, return the number of bytes.
+/** Locale independent, \p out must have room for utf8_length(c) bytes. Code
+ *  points that are surrogates or out of range are written as U+FFFD. */
+constexpr auto u32_to_utf8(char32_t c, char* out) -> std::size_t
+{
+    if (c < 0x80) {
+        out[0] = static_cast<char>(c);
+        return 1;
+    }
+    if (c < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (c >> 6));
+        out[1] = static_cast<char>(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if ((c >= 0xD800 && c < 0xE000) || c > 0x10FFFF)
+        c = U'�';
+    if (c < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (c >> 12));
+        out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (c >> 18));
+    out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (c & 0x3F));
+    return 4;
+}
+
+/// Append the UTF-8 encoding of \p sv to \p out.
+/** Allocates at most once, to grow \p out by the exact encoded size. */
+void append_utf8(std::u32string_view sv, std::string& out);
+
+/// char32_t to UTF-8 char conversion.
 [[nodiscard]] auto u32_to_mb(char32_t c) -> std::string;
 
-/// char32_t string to Multi-byte string conversion.
-/** Depends on the currently set clocale to transform the bytes. */
+/// char32_t string to UTF-8 string conversion.
 [[nodiscard]] auto u32_to_mb(std::u32string_view sv) -> std::string;
 
 }  // namespace ox
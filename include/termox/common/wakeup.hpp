@@ -0,0 +1,36 @@
+#ifndef TERMOX_COMMON_WAKEUP_HPP
+#define TERMOX_COMMON_WAKEUP_HPP
+
+namespace ox {
+
+/// File descriptor that becomes readable when notify() is called.
+/** Lets a thread blocked in poll() on other descriptors be woken by another
+ *  thread. Uses an eventfd on Linux and a non-blocking pipe elsewhere. */
+class Wakeup {
+   public:
+    Wakeup();
+
+    Wakeup(Wakeup const&) = delete;
+    Wakeup(Wakeup&&)      = delete;
+    Wakeup& operator=(Wakeup const&) = delete;
+    Wakeup& operator=(Wakeup&&) = delete;
+
+    ~Wakeup();
+
+   public:
+    /// Make fd() readable, safe to call from any thread or signal handler.
+    void notify();
+
+    /// Consume all pending notifications, fd() is no longer readable.
+    void clear();
+
+    /// Return the descriptor to poll() for readability.
+    [[nodiscard]] auto fd() const -> int;
+
+   private:
+    int read_fd_  = -1;
+    int write_fd_ = -1;
+};
+
+}  // namespace ox
+#endif  // TERMOX_COMMON_WAKEUP_HPP
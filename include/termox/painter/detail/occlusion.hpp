@@ -0,0 +1,73 @@
+#ifndef TERMOX_PAINTER_DETAIL_OCCLUSION_HPP
+#define TERMOX_PAINTER_DETAIL_OCCLUSION_HPP
+#include <cstddef>
+#include <vector>
+
+#include <termox/terminal/detail/canvas.hpp>
+
+namespace ox {
+class Widget;
+}  // namespace ox
+
+namespace ox::detail {
+
+/// Return true if painting \p w writes its wallpaper to every cell it covers.
+/** A wallpaper with a null symbol leaves the cells below it untouched. */
+[[nodiscard]] auto is_opaque(Widget const& w) -> bool;
+
+/// Sweeps the rows of a Widget, top to bottom, tracking which are covered.
+/** Rows are visited in bands, the rows of a band are all covered by the same
+ *  opaque children. The global rectangles of the children are collected and
+ *  sorted once by reset(), each band then only adds the children that start
+ *  on it and drops those that end above it. */
+class Coverage_sweep {
+   public:
+    /// Start a sweep at the top row of \p w.
+    void reset(Widget const& w);
+
+    /// Return true if every row of the Widget has been visited.
+    [[nodiscard]] auto done() const -> bool { return top_ >= end_; }
+
+    /// Return the global y coordinate of the first row of the current band.
+    [[nodiscard]] auto top() const -> int { return top_; }
+
+    /// Return the one past the last global y coordinate of the current band.
+    [[nodiscard]] auto bottom() const -> int { return bottom_; }
+
+    /// Return the global x ranges of the current band not covered by children.
+    /** Only the ranges within the Widget are returned, sorted by x. */
+    [[nodiscard]] auto uncovered() const -> std::vector<Canvas::Span> const&
+    {
+        return uncovered_;
+    }
+
+    /// Move to the next band.
+    void next();
+
+   private:
+    struct Rectangle {
+        int left, top, right, bottom;
+    };
+
+    std::vector<Rectangle> by_top_;  // Every opaque child, sorted by top.
+    std::size_t next_child_ = 0;     // First child of by_top_ not yet active.
+    std::vector<Rectangle> active_;  // Children covering the band, by left.
+    std::vector<Canvas::Span> uncovered_;
+    int left_   = 0;
+    int right_  = 0;
+    int top_    = 0;
+    int bottom_ = 0;
+    int end_    = 0;
+
+   private:
+    /// Update active_ and uncovered_ for the band starting at top_.
+    void find_band();
+};
+
+/// Return true if painting \p w could not change any cell on the screen.
+/** Either an ancestor's area does not intersect with \p w, or opaque children
+ *  cover all of \p w and paint over anything it paints. */
+[[nodiscard]] auto is_hidden(Widget const& w) -> bool;
+
+}  // namespace ox::detail
+#endif  // TERMOX_PAINTER_DETAIL_OCCLUSION_HPP
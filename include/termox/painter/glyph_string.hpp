@@ -94,9 +94,9 @@ class Glyph_string : private std::vector<Glyph> {
     /** All Brush attributes are lost. */
     [[nodiscard]] auto u32str() const -> std::u32string;
 
-    /// Convert to a std::string.
+    /// Convert to a UTF-8 std::string.
     /** Each Glyph::symbols is converted to a (potentially) multi-byte char
-     *  string. All Brush attributes are lost. */
+     *  string, with a single allocation. All Brush attributes are lost. */
     [[nodiscard]] auto str() const -> std::string;
 
    public:
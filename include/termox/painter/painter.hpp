@@ -23,6 +23,17 @@ class Painter {
     /// Construct an object ready to paint Glyphs from \p w to \p canvas.
     Painter(Widget& w, detail::Canvas& canvas);
 
+    /// Construct a Painter that places the top left of \p w at \p origin.
+    /** For painting to a Canvas other than the screen, like a paint cache. */
+    Painter(Widget& w, detail::Canvas& canvas, Point origin);
+
+    /// Tag to construct a Painter that does not fill the Widget's wallpaper.
+    struct Skip_wallpaper {};
+
+    /// Construct a Painter over cells of \p w that are already painted.
+    /** For painting over a paint cache after it is blitted to \p canvas. */
+    Painter(Widget& w, detail::Canvas& canvas, Skip_wallpaper);
+
     Painter(Painter const&) = delete;
     Painter(Painter&&)      = delete;
     Painter& operator=(Painter const&) = delete;
@@ -52,6 +63,8 @@ class Painter {
     auto vline(Glyph tile, Point a, Point b) -> Painter&;
 
     /// Fill the entire widget screen with wallpaper.
+    /** Cells covered by opaque children are skipped, they are filled by the
+     *  children's own wallpaper. */
     auto wallpaper_fill() -> Painter&;
 
    private:
@@ -77,6 +90,7 @@ class Painter {
    private:
     Widget const& widget_;
     detail::Canvas& canvas_;
+    Point origin_;
     Brush brush_;
 };
 
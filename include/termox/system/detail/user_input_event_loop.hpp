@@ -1,11 +1,14 @@
 #ifndef TERMOX_SYSTEM_DETAIL_USER_INPUT_EVENT_LOOP_HPP
 #define TERMOX_SYSTEM_DETAIL_USER_INPUT_EVENT_LOOP_HPP
+#include <termox/system/event.hpp>
 #include <termox/system/event_loop.hpp>
 #include <termox/system/event_queue.hpp>
 
 namespace ox::detail {
 
 /// Event loop that blocks for user input on each iteration.
+/** Input that is already waiting after the blocking read is read into the
+ *  same batch, so it is sent and painted together. */
 class User_input_event_loop {
    public:
     /// Starts listening for user input events in the thread called from.
@@ -14,6 +17,9 @@ class User_input_event_loop {
     /// Sets exit flag.
     void exit(int exit_code);
 
+    /// Append \p e to the Event_queue from any thread, ends any wait on input.
+    void post(Event e);
+
     /// Return reference to the internal Event_queue.
     /** Used by System to initialize the current queue. */
     auto event_queue() -> Event_queue&;
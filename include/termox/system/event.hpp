@@ -47,6 +47,7 @@ struct Mouse_release_event {
 struct Mouse_wheel_event {
     Widget_ref receiver;
     Mouse data;
+    int count = 1;  // Consecutive identical wheel steps merged into this one.
 };
 
 struct Mouse_move_event {
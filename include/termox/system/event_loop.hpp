@@ -5,6 +5,9 @@
 #include <future>
 #include <utility>
 
+#include <termox/common/mpsc_queue.hpp>
+#include <termox/common/wakeup.hpp>
+#include <termox/system/event.hpp>
 #include <termox/system/event_queue.hpp>
 
 namespace ox {
@@ -25,10 +28,13 @@ class Event_loop {
         if (running_)
             return -1;
         running_ = true;
-        if (!exit_)
+        if (!exit_) {
+            this->take_posted();
             queue_.send_all();
+        }
         while (!exit_) {
             loop_function(queue_);
+            this->take_posted();
             queue_.send_all();
         }
         running_ = false;
@@ -64,6 +70,16 @@ class Event_loop {
     // wait, then if valid, get it
     auto wait() -> int;
 
+    /// Append \p e to this loop's Event_queue, safe to call from any thread.
+    /** Lock-free, \p e is moved into the Event_queue before the next time it
+     *  is processed. Makes wakeup_fd() readable. */
+    void post(Event e);
+
+    /// Return a descriptor that becomes readable when post() is called.
+    /** For loop_functions that block in poll(), so that a post() ends the
+     *  wait. Cleared at the start of each iteration. */
+    [[nodiscard]] auto wakeup_fd() const -> int;
+
     /// Return true if the event loop is currently running.
     [[nodiscard]] auto is_running() const -> bool;
 
@@ -82,6 +98,12 @@ class Event_loop {
     std::atomic<bool> running_ = false;
     std::atomic<bool> exit_    = false;
     Event_queue queue_;
+    Mpsc_queue<Event> posted_;
+    Wakeup wakeup_;
+
+   private:
+    /// Move every Event from post() into the Event_queue.
+    void take_posted();
 };
 
 }  // namespace ox
@@ -1,35 +1,86 @@
 #ifndef TERMOX_SYSTEM_EVENT_QUEUE_HPP
 #define TERMOX_SYSTEM_EVENT_QUEUE_HPP
 #include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include <termox/common/unique_queue.hpp>
 #include <termox/system/event_fwd.hpp>
 
 namespace ox {
+class Thread_pool;
+class Widget;
+}  // namespace ox
 
-[[nodiscard]] auto operator<(Paint_event const& x, Paint_event const& y)
-    -> bool;
+namespace ox::detail {
 
-[[nodiscard]] auto operator==(Paint_event const& a, Paint_event const& b)
-    -> bool;
+/// Partitions Paint_events into groups whose receivers do not overlap.
+/** Receivers that overlap on screen, directly or through other receivers, are
+ *  in the same group. Receivers are swept top to bottom, so only those that
+ *  share a row are compared. */
+class Paint_groups {
+   public:
+    /// Group \p events, replacing the previous groups.
+    void assign(std::vector<Paint_event> const& events);
 
-}  // namespace ox
+    /// Return the number of groups.
+    [[nodiscard]] auto size() const -> std::size_t { return ranges_.size(); }
 
-namespace ox::detail {
+    /// Call \p f with the index of each event in group \p g, in queue order.
+    template <typename F>
+    void for_each(std::size_t g, F&& f) const
+    {
+        for (auto i = ranges_[g].first; i < ranges_[g].second; ++i)
+            f(order_[i]);
+    }
+
+   private:
+    std::vector<std::size_t> roots_;
+    std::vector<std::size_t> order_;
+    std::vector<std::size_t> active_;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges_;
+
+   private:
+    /// Return the representative of the group holding event \p i.
+    [[nodiscard]] auto find(std::size_t i) -> std::size_t;
+};
 
+/// Holds at most one Paint_event per Widget, in first-post order.
+/** Each batch has a generation number unique across all Paint_queues, it is
+ *  stamped onto a Widget when its Paint_event is appended, so duplicates are
+ *  rejected in constant time. */
 class Paint_queue {
    public:
+    Paint_queue();
+
+   public:
+    /// Append \p e unless its receiver already has a Paint_event in this batch.
     void append(Paint_event e);
 
     /// Return true if any events are actually sent.
+    /** Starts a new batch. */
     auto send_all() -> bool;
 
     [[nodiscard]] auto size() const -> std::size_t;
 
    private:
-    Unique_queue<Paint_event> events_;
+    std::vector<Paint_event> events_;
+    std::uint64_t generation_;
+
+    // Scratch space for send_parallel(), kept to reduce allocations.
+    std::vector<Paint_event> visible_;
+    Paint_groups groups_;
+
+   private:
+    /// Send the events in order, return true if any were sent.
+    auto send_serial() -> bool;
+
+    /// Send the events with \p pool, return true if any were sent.
+    /** Events whose receivers overlap on screen are grouped and sent in order,
+     *  groups are sent concurrently. */
+    auto send_parallel(Thread_pool& pool) -> bool;
 };
 
 class Delete_queue {
@@ -44,16 +95,56 @@ class Delete_queue {
     std::vector<Delete_event> deletes_;
 };
 
+/// Holds Events in post order, geometry Events are coalesced per receiver.
+/** A Move_event or Resize_event for a receiver that already has one waiting to
+ *  be sent overwrites the waiting Event's value, keeping its place in the
+ *  queue. A Child_polished_event is dropped if the same receiver and child
+ *  pair is already waiting. Unless the receiver has raw mouse input, a
+ *  Mouse_move_event directly after a waiting one with the same receiver and
+ *  buttons replaces its data, and an identical Mouse_wheel_event directly
+ *  after a waiting one adds to its count. */
 class Basic_queue {
    public:
     void append(Event e);
 
+    void append(Move_event e);
+
+    void append(Resize_event e);
+
+    void append(Child_polished_event e);
+
+    void append(Mouse_move_event e);
+
+    void append(Mouse_wheel_event e);
+
     auto send_all() -> bool;
 
     [[nodiscard]] auto size() const -> std::size_t;
 
+   private:
+    /// Return the last Event if it is waiting and holds a T, else nullptr.
+    template <typename T>
+    [[nodiscard]] auto waiting_back() -> T*;
+
+   private:
+    struct Pair_hash {
+        auto operator()(std::pair<Widget const*, Widget const*> p) const
+            -> std::size_t;
+    };
+
    private:
     std::vector<Event> basics_;
+
+    // Index of the next Event to send, those before it have been moved from.
+    std::size_t next_ = 0;
+
+    // Index into basics_ of the latest coalesced Event for each key.
+    std::unordered_map<Widget const*, std::size_t> moves_;
+    std::unordered_map<Widget const*, std::size_t> resizes_;
+    std::unordered_map<std::pair<Widget const*, Widget const*>,
+                       std::size_t,
+                       Pair_hash>
+        polishes_;
 };
 
 }  // namespace ox::detail
@@ -65,9 +156,13 @@ class Event_queue {
     /// Adds the given event with priority for the underlying event type.
     void append(Event e);
 
-    /// Send all events, then flush the screen if any events were actually sent.
+    /// Send all events, then request a present if any events were sent.
+    /** Presents are coalesced by System's Render_engine. */
     void send_all();
 
+    /// Held while any Event_queue is processed and while a frame is presented.
+    [[nodiscard]] static auto mutex() -> std::mutex&;
+
    private:
     detail::Basic_queue basics_;
     detail::Paint_queue paints_;
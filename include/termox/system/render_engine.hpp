@@ -0,0 +1,68 @@
+#ifndef TERMOX_SYSTEM_RENDER_ENGINE_HPP
+#define TERMOX_SYSTEM_RENDER_ENGINE_HPP
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <termox/common/fps.hpp>
+#include <termox/common/lockable.hpp>
+#include <termox/common/timer.hpp>
+
+namespace ox {
+
+/// Presents frames to the terminal from its own thread, at a capped rate.
+/** Every Event_loop requests a present after processing its Event_queue, the
+ *  requests are coalesced so at most one frame is written per interval, no
+ *  matter how many loops painted in that time. */
+class Render_engine : private Lockable<std::mutex> {
+   public:
+    using Clock_t    = Timer::Clock_t;
+    using Duration_t = Timer::Duration_t;
+    using Time_point = Timer::Time_point;
+
+    static auto constexpr default_fps = FPS{60};
+
+   public:
+    /// Set the maximum number of frames presented per second.
+    void set_fps(FPS fps);
+
+    /// Set the minimum time between presented frames.
+    /** Duration_t{0} presents every request as soon as it is made. */
+    void set_interval(Duration_t interval);
+
+    /// Return the minimum time between presented frames.
+    [[nodiscard]] auto get_interval() const -> Duration_t;
+
+    /// Ask for a frame to be presented once the interval allows.
+    /** Presents immediately on the calling thread if not running. */
+    void request_present();
+
+    /// Present the next frame as soon as possible, ignoring the interval.
+    void present_now();
+
+    /// Start the render thread, no-op if already running.
+    void start();
+
+    /// Sends exit signal and waits for the render thread to exit.
+    /** A pending request is presented before the thread exits. */
+    void stop();
+
+    /// Return true if start() has been called, and hasn't been stopped.
+    [[nodiscard]] auto is_running() const -> bool;
+
+   private:
+    std::thread thread_;
+    std::condition_variable condition_;
+    Duration_t interval_ = fps_to_period<Duration_t>(default_fps);
+    Time_point last_present_;
+    bool pending_   = false;
+    bool immediate_ = false;
+    bool exit_      = false;
+
+   private:
+    /// Wait for requests, then present one frame per interval until exit.
+    void loop_function();
+};
+
+}  // namespace ox
+#endif  // TERMOX_SYSTEM_RENDER_ENGINE_HPP
@@ -1,20 +1,26 @@
 #ifndef TERMOX_SYSTEM_SYSTEM_HPP
 #define TERMOX_SYSTEM_SYSTEM_HPP
 #include <atomic>
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <utility>
 
 #include <signals_light/signal.hpp>
 
+#include <termox/common/fps.hpp>
+#include <termox/common/thread_pool.hpp>
 #include <termox/system/animation_engine.hpp>
 #include <termox/system/detail/user_input_event_loop.hpp>
 #include <termox/system/event_fwd.hpp>
+#include <termox/system/render_engine.hpp>
 #include <termox/terminal/key_mode.hpp>
 #include <termox/terminal/mouse_mode.hpp>
 #include <termox/terminal/signals.hpp>
 #include <termox/widget/cursor.hpp>
 
 namespace ox {
+class Terminal_sink;
 class Widget;
 class Event_queue;
 }  // namespace ox
@@ -58,6 +64,10 @@ class System {
            Key_mode key_mode     = Key_mode::Normal,
            Signals signals       = Signals::On);
 
+    /// Initializes the display system with \p sink in place of the terminal.
+    /** For benchmarks and tests, see Terminal::initialize(Terminal_sink&). */
+    explicit System(Terminal_sink& sink);
+
     System(System const&) = delete;
     System& operator=(System const&) = delete;
     System(System&&)                 = default;
@@ -129,7 +139,10 @@ class System {
     /// Append the event to the Event_queue for the thread it was called on.
     /** The Event_queue is processed once per iteration of the Event_loop. When
      *  the Event is pulled from the Event_queue, it is processed by
-     *  System::send_event() */
+     *  System::send_event(). Safe to call from any thread, if the calling
+     *  thread is not processing an Event_queue the Event is posted to the user
+     *  input Event_loop, without locking, and wakes it from waiting on input.
+     */
     static void post_event(Event e);
 
     /// Sets the exit flag for the user input event loop.
@@ -152,18 +165,49 @@ class System {
     /** Does not stop the animation_engine, even if its empty. */
     static void disable_animation(Widget& w);
 
+    /// Set the maximum number of frames written to the terminal per second.
+    /** Paint results from every Event_loop are coalesced into at most one
+     *  frame per period. Defaults to Render_engine::default_fps. */
+    static void set_max_fps(FPS fps);
+
+    /// Present the next frame without waiting out the FPS cap.
+    /** For latency critical responses to input, call from the Event handler,
+     *  the frame is written as soon as the current Event_queue is processed. */
+    static void present_now();
+
+    /// Paint Widgets that do not overlap on screen on up to \p threads at once.
+    /** Each batch of Paint_events is split into groups whose Widgets do not
+     *  overlap. Groups are painted concurrently, and each group is painted in
+     *  order on one thread. 0 or 1 paints on the Event_loop's thread, the
+     *  default. paint_event() overrides must then only touch their own
+     *  Widget's state, and must not post Events. Takes effect at the start of
+     *  the next batch, so it is safe to call from an Event handler. */
+    static void set_paint_threads(std::size_t threads);
+
+    /// Return the pool that paints concurrently, nullptr if painting serially.
+    /** Creates or replaces the pool if set_paint_threads() was called since.
+     *  Should only be used by Paint_queue, with Event_queue::mutex() held. */
+    [[nodiscard]] static auto paint_pool() -> Thread_pool*;
+
+    /// Ask for the screen to be flushed, coalesced by the Render_engine.
+    /** Called by Event_queue::send_all. */
+    static void request_present();
+
     /// Set the terminal cursor via \p cursor parameters and \p offset applied.
     static void set_cursor(Cursor cursor, Point offset);
 
-    /// Set the Event_queue that will be used by post_event.
-    /** Set by Event_queue::send_all. */
-    static void set_current_queue(Event_queue& queue);
+    /// Set the Event_queue that will be used by post_event on this thread.
+    /** Set by Event_queue::send_all, and reset to nullptr when it returns. */
+    static void set_current_queue(Event_queue* queue);
 
    private:
     inline static std::atomic<Widget*> head_ = nullptr;
     static detail::User_input_event_loop user_input_loop_;
     static Animation_engine animation_engine_;
-    static std::reference_wrapper<Event_queue> current_queue_;
+    static Render_engine render_engine_;
+    static std::unique_ptr<Thread_pool> paint_pool_;
+    inline static std::atomic<std::size_t> paint_threads_ = 0;
+    inline static thread_local Event_queue* current_queue_ = nullptr;
 };
 
 }  // namespace ox
@@ -1,7 +1,10 @@
 #ifndef TERMOX_TERMINAL_DETAIL_CANVAS_HPP
 #define TERMOX_TERMINAL_DETAIL_CANVAS_HPP
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -12,6 +15,8 @@
 
 namespace ox::detail {
 
+class Color_usage;
+
 /// A 2D field of Glyphs, useful as a screen buffer.
 /** Used by Painter to write output to, which is eventually written to the
  *  actual terminal screen. */
@@ -23,6 +28,13 @@ class Canvas {
     /// Type used to model differences between two Canvas objects.
     using Diff = std::vector<std::pair<ox::Point, ox::Glyph>>;
 
+    /// Half open range [begin, end) of x or y coordinates.
+    /** Empty if begin >= end. */
+    struct Span {
+        int begin = 0;
+        int end   = 0;
+    };
+
    public:
     /// Construct a new Canvas with Area of \p a.
     Canvas(ox::Area a);
@@ -35,8 +47,41 @@ class Canvas {
     [[nodiscard]] auto at(ox::Point p) const -> ox::Glyph;
 
     /// Return the Glyph at Point \p p.
+    /** Marks \p p as dirty, since the Glyph can be written through the
+     *  returned reference. */
     [[nodiscard]] auto at(ox::Point p) -> ox::Glyph&;
 
+    /// Set the \p width Glyphs starting at \p p, along row p.y, to \p g.
+    /** The range must be within the Canvas. Marked dirty as a single span. */
+    void fill_row(ox::Point p, int width, ox::Glyph g);
+
+    /// Copy the Glyphs of \p src into this Canvas, placing its top left at \p p.
+    /** Null Glyphs in \p src are skipped, so cells it did not paint are left
+     *  as they are. \p src is clipped to this Canvas. */
+    void blit(Canvas const& src, ox::Point p);
+
+    /// Mark the Glyphs in \p a, with top left at \p p, as dirty.
+    /** Clipped to the Canvas. The cells are added to write_count(). */
+    void mark_dirty_area(ox::Point p, ox::Area a);
+
+    /// Set whether writes through at(), fill_row() and blit() are recorded.
+    /** With recording off, writes do not touch the dirty spans or the write
+     *  count, so separate cells can be written from several threads at once.
+     *  The cells must be marked beforehand with mark_dirty_area(). On by
+     *  default. */
+    void set_write_tracking(bool enable);
+
+    /// Return the x range of Glyphs on row \p y written to since reset().
+    [[nodiscard]] auto dirty_span(int y) const -> Span;
+
+    /// Return the range of rows that have a non-empty dirty_span().
+    /** Rows within this range can still have an empty dirty_span(). */
+    [[nodiscard]] auto dirty_rows() const -> Span;
+
+    /// Return the number of Glyph writes through at() and fill_row().
+    /** Counted since the last reset(), a Glyph written twice counts twice. */
+    [[nodiscard]] auto write_count() const -> std::size_t;
+
    public:
     /// Resize the Canvas to the given Area \p a.
     /** Will throw out any Glyphs from the current Canvas that no longer fit. */
@@ -44,6 +89,7 @@ class Canvas {
 
    public:
     /// Return begin iterator to internal buffer.
+    /** Writes through non-const iterators are not recorded as dirty. */
     [[nodiscard]] auto begin() -> Buffer_t::iterator;
 
     /// Return begin iterator to internal buffer.
@@ -55,31 +101,101 @@ class Canvas {
     /// Return end iterator to internal buffer.
     [[nodiscard]] auto end() const -> Buffer_t::const_iterator;
 
-    /// Sets all Glyphs to default construction.
+    /// Sets all Glyphs to default construction and clears the dirty spans.
     void reset();
 
+    /// Sets the Glyphs within the dirty spans to default construction.
+    /** Then clears the dirty spans. Cost is proportional to the number of
+     *  dirty cells. Equivalent to reset() as long as the Canvas has only been
+     *  written to through at(). */
+    void reset_dirty();
+
    private:
     Buffer_t buffer_;
     ox::Area area_;
 
+    // One Span per row, the x range written to since the last reset().
+    std::vector<Span> dirty_spans_;
+    Span dirty_rows_;
+    std::size_t write_count_ = 0;
+    bool write_tracking_     = true;
+
     std::unique_ptr<Canvas> resize_buffer_ = nullptr;
 
    private:
+    /// Add Point \p p to the dirty spans.
+    void mark_dirty(ox::Point p);
+
+    /// Mark every Glyph in the Canvas as dirty.
+    void mark_all_dirty();
+
     // Does not swap resize_buffer_
     void swap(Canvas& x);
 };
 
+/// Implementations of the inner loop of merge() and merge_and_diff().
+/** The SIMD kernels compare several Glyphs per instruction and only fall back
+ *  to scalar code for the cells that changed. */
+enum class Merge_kernel { Scalar, SSE2, AVX2 };
+
+/// Return true if the running CPU can execute Merge_kernel \p k.
+[[nodiscard]] auto is_supported(Merge_kernel k) -> bool;
+
+/// Return the fastest Merge_kernel supported by the running CPU.
+[[nodiscard]] auto best_merge_kernel() -> Merge_kernel;
+
+/// Set the Merge_kernel used by merge() and merge_and_diff().
+/** Defaults to best_merge_kernel(), \p k must be supported. */
+void set_merge_kernel(Merge_kernel k);
+
 /// Merge \p next into \p current.
-/** A Glyph with null(zero) symbol is considered an untouched cell. */
-void merge(Canvas const& next, Canvas& current);
+/** A Glyph with null(zero) symbol is considered an untouched cell. Only the
+ *  dirty spans of \p next are visited. Each change is recorded in \p usage if
+ *  it is not nullptr. */
+void merge(Canvas const& next,
+           Canvas& current,
+           Color_usage* usage = nullptr);
 
 /// Merge \p next into \p current, producing a diff of the changes.
 /** The diff is stored into \p diff_out, which is cleared at the start.
  *  diff_out is an out parameter for efficiency, to reduce allocations. A
- *  Glyph with null(zero) symbol is considered an untouched cell. */
+ *  Glyph with null(zero) symbol is considered an untouched cell. Only the
+ *  dirty spans of \p next are visited. Each change is recorded in \p usage if
+ *  it is not nullptr. */
 void merge_and_diff(Canvas const& next,
                     Canvas& current,
-                    Canvas::Diff& diff_out);
+                    Canvas::Diff& diff_out,
+                    Color_usage* usage = nullptr);
+
+/// Full width rows [top, bottom) scrolled by distance rows.
+/** A positive distance moves content up, a negative distance moves it down.
+ *  The abs(distance) rows scrolled into view at the bottom, or top, are the
+ *  exposed rows and have unknown contents on the terminal. */
+struct Vertical_shift {
+    int top      = 0;
+    int bottom   = 0;
+    int distance = 0;
+};
+
+/// Find the band of rows that merging \p next would move vertically.
+/** Compares a hash of each row of \p current with each row as it will be after
+ *  \p next is merged into it. Only rows whose dirty_span() covers more than
+ *  half the width are hashed, and shifts of at most 32 rows are tried, so a
+ *  sparse frame costs one dirty_span() lookup per row. The shift that leaves
+ *  the most changed rows already in place is returned, or std::nullopt if
+ *  that is fewer than two rows. \p hashes is scratch space, passed in to
+ *  reduce allocations. */
+[[nodiscard]] auto find_vertical_shift(Canvas const& next,
+                                       Canvas const& current,
+                                       std::vector<std::uint64_t>& hashes)
+    -> std::optional<Vertical_shift>;
+
+/// Update \p next and \p current to reflect the terminal scrolling by \p s.
+/** Rows of \p current are moved by s.distance and its exposed rows are set to
+ *  null Glyphs. The untouched cells of \p next in the exposed rows are given
+ *  their previous value from \p current, so a following merge_and_diff()
+ *  repaints them. */
+void apply_vertical_shift(Vertical_shift s, Canvas& next, Canvas& current);
 
 /// Generate a Canvas::Diff containing only the items that contain \p color.
 /** Added to the diff if \p color can be found in either the Glyph's
@@ -89,6 +205,15 @@ void generate_color_diff(Color color,
                          Canvas const& canvas,
                          Canvas::Diff& diff_out);
 
+/// Generate a Canvas::Diff containing only the items that contain \p color.
+/** Same as above, but only visits the rows that \p usage has \p color on,
+ *  and the columns of each it bounds \p color to. \p usage must be up to date
+ *  with \p canvas. */
+void generate_color_diff(Color color,
+                         Canvas const& canvas,
+                         Color_usage const& usage,
+                         Canvas::Diff& diff_out);
+
 /// Writes the entire contents of \p canvas into \p diff_out.
 /** Clears diff_out before writing. */
 void generate_full_diff(Canvas const& canvas, Canvas::Diff& diff_out);
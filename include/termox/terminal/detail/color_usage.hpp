@@ -0,0 +1,104 @@
+#ifndef TERMOX_TERMINAL_DETAIL_COLOR_USAGE_HPP
+#define TERMOX_TERMINAL_DETAIL_COLOR_USAGE_HPP
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+#include <termox/widget/point.hpp>
+
+namespace ox::detail {
+
+/// Counts, per Color and row, the Glyphs of a Canvas that use the Color.
+/** A Glyph uses a Color if it is its foreground or background. Kept up to date
+ *  by merge() and merge_and_diff(), so finding every Glyph with a given Color
+ *  only visits the rows that contain one, and on each of those only the
+ *  columns between the first and last Glyph that used it. These columns only
+ *  grow until the row has no Glyph with the Color left or is recounted, so a
+ *  Color spread thinly across a row still costs the width it spans. */
+class Color_usage {
+   public:
+    /// Recount every row of \p canvas, resizing to fit its height.
+    void rebuild(Canvas const& canvas);
+
+    /// Recount rows [rows.begin, rows.end) of \p canvas.
+    void recount(Canvas const& canvas, Canvas::Span rows);
+
+    /// Account for the Glyph at \p p changing from \p from to \p to.
+    void replace(Glyph from, Glyph to, Point p)
+    {
+        auto const& f = from.brush;
+        auto const& t = to.brush;
+        if (f.foreground == t.foreground && f.background == t.background)
+            return;
+        this->remove(from, p.y);
+        this->add(to, p);
+    }
+
+    /// Return true if row \p y has at least one Glyph that uses \p c.
+    [[nodiscard]] auto is_used(Color c, int y) const -> bool
+    {
+        return counts_[this->index(c, y)] != 0;
+    }
+
+    /// Return the columns of row \p y that hold every Glyph that uses \p c.
+    /** Empty if is_used(c, y) is false. */
+    [[nodiscard]] auto columns(Color c, int y) const -> Canvas::Span
+    {
+        return columns_[this->index(c, y)];
+    }
+
+    /// Return the number of rows counted.
+    [[nodiscard]] auto height() const -> int { return height_; }
+
+   private:
+    // Both indexed by [Color::value][row].
+    std::vector<std::uint16_t> counts_;
+    std::vector<Canvas::Span> columns_;
+    int height_ = 0;
+
+   private:
+    [[nodiscard]] auto index(Color c, int y) const -> std::size_t
+    {
+        return (static_cast<std::size_t>(c.value) * height_) + y;
+    }
+
+    void add(Glyph g, Point p)
+    {
+        this->add(g.brush.foreground, p);
+        if (g.brush.background != g.brush.foreground)
+            this->add(g.brush.background, p);
+    }
+
+    void add(Color c, Point p)
+    {
+        auto const i = this->index(c, p.y);
+        auto& span   = columns_[i];
+        if (counts_[i]++ == 0)
+            span = {p.x, p.x + 1};
+        else {
+            span.begin = std::min(span.begin, p.x);
+            span.end   = std::max(span.end, p.x + 1);
+        }
+    }
+
+    void remove(Glyph g, int y)
+    {
+        this->remove(g.brush.foreground, y);
+        if (g.brush.background != g.brush.foreground)
+            this->remove(g.brush.background, y);
+    }
+
+    void remove(Color c, int y)
+    {
+        auto const i = this->index(c, y);
+        if (--counts_[i] == 0)
+            columns_[i] = Canvas::Span{};
+    }
+};
+
+}  // namespace ox::detail
+#endif  // TERMOX_TERMINAL_DETAIL_COLOR_USAGE_HPP
@@ -0,0 +1,105 @@
+#ifndef TERMOX_TERMINAL_DETAIL_DIFF_ENCODER_HPP
+#define TERMOX_TERMINAL_DETAIL_DIFF_ENCODER_HPP
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/painter/trait.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+#include <termox/widget/point.hpp>
+
+namespace ox::detail {
+
+/// Translates a Canvas::Diff into the escape sequences that display it.
+/** Tracks the terminal's cursor position and SGR(traits and colors) state while
+ *  walking a Diff. Cursor moves are skipped for cells directly to the right of
+ *  the last written cell, and trait and color sequences are only written when
+ *  they differ from the previous cell. Runs of identical Glyphs along a row
+ *  can be erased with ECH if blank, or written once and repeated with REP. */
+class Diff_encoder {
+   public:
+    /// Every Color starts out mapped to the terminal default colors.
+    Diff_encoder();
+
+    /// Set the escape sequences that select Color \p c as fore/background.
+    /** Each sequence must fit within Color_sequence::capacity bytes. */
+    void set_color_sequences(Color c, std::string_view fg, std::string_view bg);
+
+    /// Set Color \p c to display as \p tc, updated in place without allocating.
+    void set_color_sequences(Color c, True_color tc);
+
+    /// Set whether runs of identical Glyphs are written with REP, 'ESC[nb'.
+    /** Off by default, REP is not implemented by every terminal. */
+    void set_repeat(bool enable);
+
+    /// Set whether runs of blank Glyphs are erased with ECH, 'ESC[nX'.
+    /** Off by default, erased cells only take the current background color on
+     *  terminals with background color erase(BCE). */
+    void set_erase(bool enable);
+
+    /// Append the escape sequences that display \p diff to \p out.
+    /** The terminal state is unknown at the start of each call, so the first
+     *  cell always writes its cursor position, traits and colors. Sequences
+     *  are written directly into \p out, once every Color and Traits in use
+     *  has been seen this does not allocate beyond the growth of \p out. */
+    void encode(Canvas::Diff const& diff, std::string& out);
+
+    /// Append the sequences that scroll rows by \p s to \p out.
+    /** Sets the scroll region with DECSTBM, scrolls with SU or SD and then
+     *  resets the region. SGR is reset first, so exposed rows are blank with
+     *  the default background. */
+    void encode_scroll(Vertical_shift s, std::string& out);
+
+   private:
+    /// Forget the tracked cursor position and SGR state.
+    void reset_state();
+
+    /// Write the cursor position to \p p to \p out if it is not already there.
+    void move_cursor(Point p, std::string& out);
+
+    /// Write the traits and colors of \p g to \p out if they have changed.
+    void set_brush(Glyph g, std::string& out);
+
+    /// Return the sequence to set Traits \p t, cached after the first call.
+    [[nodiscard]] auto traits_sequence(Traits t) -> std::string const&;
+
+   private:
+    /// Pre-rendered escape sequence stored inline.
+    struct Color_sequence {
+        /// Longest is a true color sequence: 'ESC[38;2;255;255;255m'.
+        static auto constexpr capacity = 23;
+
+        std::array<char, capacity> bytes = {};
+        std::uint8_t size                = 0;
+
+        /// Copy \p sequence into bytes, truncated to capacity.
+        void assign(std::string_view sequence);
+
+        [[nodiscard]] auto view() const -> std::string_view
+        {
+            return {bytes.data(), size};
+        }
+    };
+
+    // Indexed by Color::value, Colors not in the palette hold the default.
+    std::array<Color_sequence, 256> fg_table_;
+    std::array<Color_sequence, 256> bg_table_;
+    std::vector<std::pair<Traits, std::string>> traits_store_;
+    bool repeat_ = false;
+    bool erase_  = false;
+
+    // Terminal state, std::nullopt if unknown.
+    std::optional<Point> cursor_;
+    std::optional<Traits> traits_;
+    std::optional<Color> foreground_;
+    std::optional<Color> background_;
+};
+
+}  // namespace ox::detail
+#endif  // TERMOX_TERMINAL_DETAIL_DIFF_ENCODER_HPP
@@ -1,6 +1,11 @@
 #ifndef TERMOX_TERMINAL_DETAIL_SCREEN_BUFFERS_HPP
 #define TERMOX_TERMINAL_DETAIL_SCREEN_BUFFERS_HPP
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 #include <termox/terminal/detail/canvas.hpp>
+#include <termox/terminal/detail/color_usage.hpp>
 #include <termox/widget/area.hpp>
 
 namespace ox::detail {
@@ -34,10 +39,18 @@ class Screen_buffers {
      *  current, and writes that change to the returned Canvas::Diff object. */
     [[nodiscard]] auto merge_and_diff() -> Canvas::Diff const&;
 
+    /// Return the band of rows that merging next would move vertically.
+    /** See find_vertical_shift(). */
+    [[nodiscard]] auto find_vertical_shift() -> std::optional<Vertical_shift>;
+
+    /// Update both buffers to reflect the terminal scrolling by \p s.
+    /** Must be called before merge_and_diff(), see apply_vertical_shift(). */
+    void apply_vertical_shift(Vertical_shift s);
+
     /// Generates a Canvas::Diff, with every Glyph from current that has \p c.
     /** This isn't a true difference, it is meant to be used to generate a list
      *  of Glyphs that need to be re-written to the screen. Used by
-     *  Dynamic_color_engine. */
+     *  Dynamic_color_engine. Only rows of current that use \p c are visited. */
     [[nodiscard]] auto generate_color_diff(Color c) -> Canvas::Diff const&;
 
     /// Returns the entire current screen as a Diff. Used on Window Resize.
@@ -45,6 +58,10 @@ class Screen_buffers {
 
    private:
     Canvas::Diff diff_;
+    std::vector<std::uint64_t> row_hashes_;
+
+    // Always up to date with current.
+    Color_usage usage_;
 };
 
 }  // namespace ox::detail
@@ -0,0 +1,147 @@
+#ifndef TERMOX_TERMINAL_HEADLESS_TERMINAL_HPP
+#define TERMOX_TERMINAL_HEADLESS_TERMINAL_HPP
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <esc/event.hpp>
+
+#include <termox/common/lockable.hpp>
+#include <termox/terminal/terminal_sink.hpp>
+#include <termox/widget/area.hpp>
+#include <termox/widget/point.hpp>
+
+namespace ox {
+
+/// In-memory Terminal_sink that models a VT100/xterm screen.
+/** Parses the escape sequences written to it into a grid of Cells, so the
+ *  output of Terminal can be checked and measured without a tty. Input is
+ *  scripted with push_input(). Understands the sequences TermOx emits: cursor
+ *  positioning and movement, SGR, scroll regions and scrolling, erasing, REP
+ *  and palette redefinition with OSC 4 and OSC 104. Every other sequence is
+ *  consumed and ignored. Each Cell holds one
+ *  symbol, wide characters are not modeled. */
+class Headless_terminal : public Terminal_sink, private Lockable<std::mutex> {
+   public:
+    /// A color as set by SGR.
+    struct Cell_color {
+        enum class Kind : std::uint8_t { Default, Index, RGB };
+
+        Kind kind           = Kind::Default;
+        std::uint32_t value = 0;  // Palette index, or 0xRRGGBB.
+
+        [[nodiscard]] friend auto operator==(Cell_color a, Cell_color b)
+            -> bool
+        {
+            return a.kind == b.kind && a.value == b.value;
+        }
+
+        [[nodiscard]] friend auto operator!=(Cell_color a, Cell_color b)
+            -> bool
+        {
+            return !(a == b);
+        }
+    };
+
+    struct Cell {
+        char32_t symbol = U' ';
+        Cell_color foreground;
+        Cell_color background;
+        std::uint16_t attributes = 0;  // Bit n is set if SGR n is on, [1, 9].
+    };
+
+    /// Totals since construction or the last reset_stats().
+    struct Stats {
+        std::size_t bytes  = 0;
+        std::size_t writes = 0;
+    };
+
+   public:
+    /// Construct with every Cell blank and the cursor at the top left.
+    explicit Headless_terminal(Area a);
+
+   public:
+    [[nodiscard]] auto area() const -> Area override;
+
+    /// Parse \p bytes, a sequence may be split across multiple calls.
+    void write(std::string_view bytes) override;
+
+    /// Block until push_input() has been called, return the oldest Event.
+    [[nodiscard]] auto read() -> esc::Event override;
+
+    /// Return true if push_input() has Events that have not been read.
+    [[nodiscard]] auto has_input() const -> bool override;
+
+   public:
+    /// Append \p e to the input read by Terminal::read_input().
+    void push_input(esc::Event e);
+
+    /// Return the Cell at \p p.
+    [[nodiscard]] auto at(Point p) const -> Cell;
+
+    /// Return the symbols of row \p y.
+    [[nodiscard]] auto row(int y) const -> std::u32string;
+
+    /// Return the 0xRRGGBB value palette entry \p index was redefined to.
+    /** Returns std::nullopt if the entry has the terminal default color. */
+    [[nodiscard]] auto palette_entry(int index) const
+        -> std::optional<std::uint32_t>;
+
+    /// Return the cursor position.
+    [[nodiscard]] auto cursor() const -> Point;
+
+    /// Return the output totals.
+    [[nodiscard]] auto stats() const -> Stats;
+
+    /// Set the output totals to zero.
+    void reset_stats();
+
+   private:
+    Area area_;
+    std::vector<Cell> cells_;
+    Point cursor_ = {0, 0};
+    Cell pen_;  // SGR state, its symbol is the last one written, for REP.
+    int scroll_top_    = 0;
+    int scroll_bottom_ = 0;
+    std::string partial_;  // Incomplete sequence at the end of a write.
+    std::map<int, std::uint32_t> palette_;  // Redefined entries only.
+    Stats stats_;
+
+    std::deque<esc::Event> input_;
+    std::condition_variable input_ready_;
+
+   private:
+    /// Apply the sequence or character at the front of \p bytes.
+    /** Returns the number of bytes used, zero if \p bytes is incomplete. */
+    [[nodiscard]] auto apply(std::string_view bytes) -> std::size_t;
+
+    /// Apply a CSI sequence, \p body is everything after 'ESC['.
+    void apply_csi(std::string_view body);
+
+    /// Apply an OSC sequence, \p body is everything between 'ESC]' and ST.
+    void apply_osc(std::string_view body);
+
+    /// Apply an SGR sequence with parameters \p params.
+    void apply_sgr(std::vector<int> const& params);
+
+    /// Write \p symbol at the cursor and advance the cursor.
+    void put(char32_t symbol);
+
+    /// Scroll rows within the scroll region up by \p n, down if negative.
+    void scroll(int n);
+
+    /// Set Cells [begin, end) of row \p y to blank with the pen's background.
+    void erase(int y, int begin, int end);
+
+    [[nodiscard]] auto cell(Point p) -> Cell&;
+};
+
+}  // namespace ox
+#endif  // TERMOX_TERMINAL_HEADLESS_TERMINAL_HPP
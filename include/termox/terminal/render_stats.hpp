@@ -0,0 +1,37 @@
+#ifndef TERMOX_TERMINAL_RENDER_STATS_HPP
+#define TERMOX_TERMINAL_RENDER_STATS_HPP
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ox {
+
+/// The cost of a single Terminal::refresh().
+struct Render_stats {
+    /// Number of refresh() calls so far, including this one.
+    std::uint64_t frame = 0;
+
+    /// Cells of the next buffer compared against the current buffer.
+    std::size_t cells_diffed = 0;
+
+    /// Glyphs written into the next buffer while painting, counting overdraw.
+    /** Each cell painted by more than one Widget is counted once per Widget,
+     *  cells_painted / cells_diffed is about the average overdraw. */
+    std::size_t cells_painted = 0;
+
+    /// Cells written to the terminal.
+    std::size_t cells_emitted = 0;
+
+    /// Bytes written to the terminal, including scroll and sync sequences.
+    std::size_t bytes_written = 0;
+
+    std::chrono::nanoseconds merge_time  = {};
+    std::chrono::nanoseconds encode_time = {};
+    std::chrono::nanoseconds write_time  = {};
+
+    /// True if every cell was written, after flag_full_repaint().
+    bool full_repaint = false;
+};
+
+}  // namespace ox
+#endif  // TERMOX_TERMINAL_RENDER_STATS_HPP
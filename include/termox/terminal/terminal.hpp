@@ -1,6 +1,7 @@
 #ifndef TERMOX_TERMINAL_TERMINAL_HPP
 #define TERMOX_TERMINAL_TERMINAL_HPP
 #include <cstdint>
+#include <optional>
 
 #include <signals_light/signal.hpp>
 
@@ -11,7 +12,9 @@
 #include <termox/terminal/dynamic_color_engine.hpp>
 #include <termox/terminal/key_mode.hpp>
 #include <termox/terminal/mouse_mode.hpp>
+#include <termox/terminal/render_stats.hpp>
 #include <termox/terminal/signals.hpp>
+#include <termox/terminal/terminal_sink.hpp>
 #include <termox/widget/area.hpp>
 
 namespace ox {
@@ -20,6 +23,10 @@ class Terminal {
    public:
     inline static sl::Signal<void(Palette const&)> palette_changed;
 
+    /// Emitted at the end of each refresh(), on the thread that called it.
+    /** Slots run before the next frame can start, keep them short. */
+    inline static sl::Signal<void(Render_stats const&)> frame_rendered;
+
     inline static detail::Screen_buffers screen_buffers{Area{0, 0}};
 
    public:
@@ -52,6 +59,14 @@ class Terminal {
                            Key_mode key_mode     = Key_mode::Normal,
                            Signals signals       = Signals::On);
 
+    /// Initialize with all output written to and input read from \p sink.
+    /** The real terminal is left untouched, stdin and stdout are not used.
+     *  The screen takes the fixed Area of \p sink. 256 colors, true color, REP,
+     *  BCE and OSC 4 palette redefinition are assumed and no terminal features
+     *  are queried. \p sink must outlive the call to uninitialize(). No-op if
+     *  initialized. */
+    static void initialize(Terminal_sink& sink);
+
     /// Reset the terminal to its state before initialize() was called.
     /** No-op if already uninitialized. */
     static void uninitialize();
@@ -64,12 +79,19 @@ class Terminal {
      *  separately for the currently in-focus Widget. */
     static void refresh();
 
+    /// Return the statistics of the most recent refresh().
+    /** Safe to call from any thread, this does not lock or wait on refresh().
+     *  All members are zero before the first refresh(). */
+    [[nodiscard]] static auto last_frame_stats() -> Render_stats;
+
     /// Update a Color Palette value.
-    /** Used by Dynamic_color_engine. */
+    /** Used by Dynamic_color_engine. If \p c is bound to a terminal palette
+     *  entry, that entry is redefined and appears on screen immediately. */
     static void update_color_stores(Color c, True_color tc);
 
     /// Repaints all Glyphs with \p c in their Brush to the screen.
-    /** Used by Dynamic_color_engine. */
+    /** Used by Dynamic_color_engine. No-op if \p c is bound to a terminal
+     *  palette entry, the terminal recolors those Glyphs itself. */
     static void repaint_color(Color c);
 
     /// Change Color definitions.
@@ -97,11 +119,26 @@ class Terminal {
     /// Return true if this terminal supports true color.
     [[nodiscard]] static auto has_true_color() -> bool;
 
+    /// Block until user input is available or \p wakeup_fd is readable.
+    /** Return true if input is available, read_input() will not block for long
+     *  then. Input the escape sequence parser has already buffered counts as
+     *  available. With a Terminal_sink this returns true immediately, the
+     *  sink's read() does the waiting. */
+    [[nodiscard]] static auto wait_for_input(int wakeup_fd) -> bool;
+
     /// Wait for user input, and return with a corresponding Event.
     /** Blocking call, input can be received from the keyboard, mouse, or the
      *  terminal being resized. Will return nullopt if there is an error. */
     [[nodiscard]] static auto read_input() -> Event;
 
+    /// Return the next input Event if it can be read without blocking.
+    /** Used to read everything available into one batch. Earlier Events in
+     *  the batch can change the focus Widget, so key Events are returned as
+     *  Custom_events that find their receiver when sent. Returns nullopt if
+     *  no input is waiting, neither on stdin nor buffered by the escape
+     *  sequence parser, see also Terminal_sink::has_input(). */
+    [[nodiscard]] static auto read_pending_input() -> std::optional<Event>;
+
     /// Sets a flag so that the next call to refresh() will repaint every cell.
     /** The repaint forces the diff to contain every cell on the terminal. */
     static void flag_full_repaint();
@@ -109,6 +146,41 @@ class Terminal {
     /// Flushes all of the staged changes to the screen and sets the cursor.
     static void flush_screen();
 
+    /// Wrap each frame in synchronized update sequences, DEC private mode 2026.
+    /** The terminal then applies a frame all at once instead of drawing it in
+     *  pieces as it arrives. Off by default, and has no effect unless the
+     *  terminal reported support for mode 2026 during initialize(). */
+    static void set_synchronized_output(bool enable = true);
+
+    /// Return true if frames are currently written as synchronized updates.
+    [[nodiscard]] static auto is_synchronized_output() -> bool;
+
+    /// Return true if the terminal reported support for DEC mode 2026.
+    /** Queried during initialize(), always false before then. */
+    [[nodiscard]] static auto has_synchronized_output() -> bool;
+
+    /// Animate Dynamic_colors by redefining terminal palette entries, OSC 4.
+    /** Each Dynamic_color in the palette is bound to an unused entry at the
+     *  top of the terminal's 256 color palette, and each update rewrites only
+     *  that entry instead of repainting every Glyph that uses the Color. On by
+     *  default, falls back to repainting if the terminal did not answer an OSC
+     *  4 query during initialize(). Takes effect at the next set_palette(). */
+    static void set_palette_redefinition(bool enable = true);
+
+    /// Return true if the terminal answered an OSC 4 palette query.
+    /** Queried during initialize(), always false before then. */
+    [[nodiscard]] static auto has_palette_redefinition() -> bool;
+
+    /// Return true if the terminal implements REP, 'ESC[nb'.
+    /** Probed during initialize(), always true for a Terminal_sink. Runs of
+     *  identical Glyphs are written once and repeated with REP if true. */
+    [[nodiscard]] static auto has_repeat() -> bool;
+
+    /// Return true if the terminal has background color erase, BCE.
+    /** Queried with XTGETTCAP during initialize(), always true for a
+     *  Terminal_sink. Runs of blank Glyphs are erased with ECH if true. */
+    [[nodiscard]] static auto has_bce() -> bool;
+
     /// Send exit flag and wait for Dynamic_color_engine thread to shutdown.
     static void stop_dynamic_color_engine();
 
@@ -122,7 +194,14 @@ class Terminal {
     inline static Dynamic_color_engine dynamic_color_engine_;
     inline static bool is_initialized_ = false;
     inline static bool full_repaint_   = false;
+    inline static std::uint64_t frame_count_ = 0;
     inline static bool handle_sigint_  = true;
+    inline static bool synchronized_output_     = false;
+    inline static bool has_synchronized_output_ = false;
+    inline static bool palette_redefinition_     = true;
+    inline static bool has_palette_redefinition_ = false;
+    inline static bool has_repeat_               = false;
+    inline static bool has_bce_                  = false;
 };
 
 }  // namespace ox
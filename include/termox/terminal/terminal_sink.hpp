@@ -0,0 +1,34 @@
+#ifndef TERMOX_TERMINAL_TERMINAL_SINK_HPP
+#define TERMOX_TERMINAL_TERMINAL_SINK_HPP
+#include <string_view>
+
+#include <esc/event.hpp>
+
+#include <termox/widget/area.hpp>
+
+namespace ox {
+
+/// Stands in for the tty, Terminal writes its output to and reads input from.
+/** Passed to Terminal::initialize() to run without a real terminal. */
+class Terminal_sink {
+   public:
+    virtual ~Terminal_sink() = default;
+
+   public:
+    /// Return the size of the screen, fixed for the life of the sink.
+    [[nodiscard]] virtual auto area() const -> Area = 0;
+
+    /// Receive \p bytes, each call is what would be a single write() to a tty.
+    virtual void write(std::string_view bytes) = 0;
+
+    /// Block until the next input Event is available and return it.
+    [[nodiscard]] virtual auto read() -> esc::Event = 0;
+
+    /// Return true if read() would return without blocking.
+    /** Lets waiting input be read into one batch. The default reports nothing
+     *  waiting, so each Event is sent in its own batch. */
+    [[nodiscard]] virtual auto has_input() const -> bool { return false; }
+};
+
+}  // namespace ox
+#endif  // TERMOX_TERMINAL_TERMINAL_SINK_HPP
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include <termox/system/event.hpp>
+#include <termox/widget/detail/link_lifetimes.hpp>
 #include <termox/widget/layout.hpp>
 #include <termox/widget/size_policy.hpp>
 
@@ -143,9 +144,7 @@ class Linear_layout : public Layout<Child> {
         Widget::child_offset_ = index;
         shared_space_.set_offset(index);
         unique_space_.set_offset(index);
-        // This works, not sure exactly why, calling resize_and_move_children
-        // directly does not work.
-        System::post_event(Child_polished_event{*this, *this});
+        this->post_relayout();
     }
 
     void decrement_offset()
@@ -207,7 +206,7 @@ class Linear_layout : public Layout<Child> {
 
     auto child_polished_event(Widget& child) -> bool override
     {
-        this->resize_and_move_children();
+        this->post_relayout();
         return Layout<Child>::child_polished_event(child);
     }
 
@@ -217,6 +216,28 @@ class Linear_layout : public Layout<Child> {
 
     Shared_space<Parameters> shared_space_;
     Unique_space<Parameters> unique_space_;
+    bool relayout_pending_ = false;
+
+   private:
+    /// Post a single relayout, sent after the Events already in the queue.
+    /** Many children polished in one batch then relayout a single time. The
+     *  relayout is dropped if *this is destroyed before it is sent. */
+    void post_relayout()
+    {
+        if (relayout_pending_)
+            return;
+        relayout_pending_ = true;
+        auto relayout     = slot::link_lifetimes(
+            [this] {
+                relayout_pending_ = false;
+                this->resize_and_move_children();
+            },
+            *this);
+        System::post_event(Custom_event{[relayout] {
+            if (!relayout.expired())
+                relayout();
+        }});
+    }
 
    private:
     void resize_and_move_children()
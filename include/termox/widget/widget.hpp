@@ -1,5 +1,6 @@
 #ifndef TERMOX_WIDGET_WIDGET_HPP
 #define TERMOX_WIDGET_WIDGET_HPP
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
@@ -20,6 +21,7 @@
 #include <termox/painter/painter.hpp>
 #include <termox/system/key.hpp>
 #include <termox/system/mouse.hpp>
+#include <termox/terminal/detail/canvas.hpp>
 #include <termox/widget/area.hpp>
 #include <termox/widget/cursor.hpp>
 #include <termox/widget/focus_policy.hpp>
@@ -242,6 +244,29 @@ class Widget {
      *  to true. */
     [[nodiscard]] auto generate_wallpaper() const -> Glyph;
 
+    /// Keep the output of paint_event() in a Canvas owned by this Widget.
+    /** Paint_events then only call paint_event() after an update() of *this,
+     *  a resize, or a child being added, removed, moved, resized, enabled or
+     *  disabled. Children are painted by their own Paint_events, so their
+     *  update() calls leave the cache of *this valid. Otherwise the kept Glyphs are copied to
+     *  the screen. The painted signal is emitted either way, its output is
+     *  not kept. For Widgets with an expensive paint_event() that are often
+     *  moved or repainted without their content changing. Off by default. */
+    void enable_paint_cache(bool enable = true);
+
+    /// Return true if the output of paint_event() is kept between paints.
+    [[nodiscard]] auto has_paint_cache() const -> bool;
+
+    /// Receive every mouse move and wheel Event as it was read.
+    /** By default, consecutive Mouse_move_events read in one batch are merged
+     *  into the latest position, and consecutive identical Mouse_wheel_events
+     *  into one Event with a count. Enable for Widgets that need each point of
+     *  a drag, such as painting. Off by default. */
+    void enable_raw_mouse_input(bool enable = true);
+
+    /// Return true if mouse move and wheel Events are not merged.
+    [[nodiscard]] auto has_raw_mouse_input() const -> bool;
+
     /// Return the index of the first child displayed by this Widget.
     [[nodiscard]] auto get_child_offset() const -> std::size_t;
 
@@ -394,6 +419,20 @@ class Widget {
 
     std::uint16_t const unique_id_;
 
+    std::unique_ptr<detail::Canvas> paint_cache_ = nullptr;
+    std::atomic<bool> paint_cache_valid_         = false;
+
+    bool raw_mouse_input_ = false;
+
+    // Paint_queue batch this Widget's last Paint_event was appended to.
+    std::atomic<std::uint64_t> paint_stamp_ = 0;
+
+   private:
+    /// Mark the paint cache of the parent of *this as out of date.
+    /** The wallpaper a parent caches skips the cells its children cover, so
+     *  it changes with the geometry of *this, not with what *this paints. */
+    void invalidate_parent_paint_cache();
+
    public:
     /// Should only be used by Move_event send() function.
     void set_top_left(Point p);
@@ -403,6 +442,23 @@ class Widget {
 
     /// Should only be used by Layout.
     void set_parent(Widget* parent);
+
+    /// Stamp this Widget with Paint_queue batch \p generation.
+    /** Return false if it was already stamped with \p generation, so its
+     *  Paint_event is already queued. Should only be used by Paint_queue. */
+    [[nodiscard]] auto stamp_paint(std::uint64_t generation) -> bool;
+
+    /// Return the paint cache if it holds the output for the current area.
+    /** Returns nullptr if there is no paint cache or if it has been
+     *  invalidated since it was painted. Should only be used by Paint_event
+     *  send(). */
+    [[nodiscard]] auto valid_paint_cache() const -> detail::Canvas const*;
+
+    /// Return the paint cache, resized to area() and reset, to be painted to.
+    /** It is valid until invalidated, see enable_paint_cache(). Returns
+     *  nullptr if there is no paint cache. Should only be used by Paint_event
+     *  send(). */
+    [[nodiscard]] auto reset_paint_cache() -> detail::Canvas*;
 };
 
 /// Helper function to create a Widget instance.
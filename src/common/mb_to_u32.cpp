@@ -1,48 +1,128 @@
 #include <termox/common/mb_to_u32.hpp>
 
 #include <cstddef>
-#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <vector>
 
-#ifdef __APPLE__
-#    include <cwchar>
-#else
-#    include <cuchar>
+#ifdef __SSE2__
+#    include <emmintrin.h>
 #endif
 
-namespace ox {
+namespace {
 
-auto mb_to_u32(std::string_view sv) -> std::u32string
+using Byte_t = unsigned char;
+
+auto constexpr replacement = U'�';
+
+/// Widen the ASCII bytes at the front of [in, end) into \p out.
+/** Returns the number of bytes converted, stops at the first non-ASCII. */
+auto copy_ascii(Byte_t const* in, Byte_t const* end, char32_t* out)
+    -> std::size_t
 {
-    auto mb_state  = std::mbstate_t{};
-    auto n         = sv.size();
-    char const* in = sv.data();
-    auto buffer    = std::vector<char32_t>(sv.size() + 1, U'\0');
-    char32_t* out  = buffer.data();
-
-    while (n != 0) {
-#ifdef __APPLE__
-        static_assert(sizeof(wchar_t) == sizeof(char32_t));
-        static_assert(alignof(wchar_t) == alignof(char32_t));
-        auto const bytes_read =
-            std::mbrtowc(reinterpret_cast<wchar_t*>(out), in, n, &mb_state);
-#else
-        auto const bytes_read = std::mbrtoc32(out, in, n, &mb_state);
+    auto const* const begin = in;
+#ifdef __SSE2__
+    auto const zero = _mm_setzero_si128();
+    while (end - in >= 16) {
+        auto const bytes =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(in));
+        if (_mm_movemask_epi8(bytes) != 0)
+            break;
+        auto const low  = _mm_unpacklo_epi8(bytes, zero);
+        auto const high = _mm_unpackhi_epi8(bytes, zero);
+        auto* const o   = reinterpret_cast<__m128i*>(out);
+        _mm_storeu_si128(o + 0, _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(high, zero));
+        in += 16;
+        out += 16;
+    }
+    // The prefix before a non-ASCII byte is copied by the loop below.
 #endif
-        switch (bytes_read) {
-            case std::size_t(-1):
-            case std::size_t(-2):
-            case std::size_t(-3):
-                throw std::runtime_error{"mb_to_u32(): Bad Byte Sequence"};
-            case 0:  // Null Byte Read
-                (++out, ++in, --n);
-                break;
-            default: (++out, in += bytes_read, n -= bytes_read); break;
+    for (; in != end && *in < 0x80; ++in)
+        *out++ = *in;
+    return static_cast<std::size_t>(in - begin);
+}
+
+/// Return true if \p b is a UTF-8 continuation byte, 10xxxxxx.
+[[nodiscard]] auto is_continuation(Byte_t b) -> bool
+{
+    return (b & 0xC0) == 0x80;
+}
+
+/// Decode the multi-byte sequence at the front of [in, end) into \p out.
+/** Returns the number of bytes consumed, at least one. Invalid sequences
+ *  write U+FFFD and consume the longest prefix that was valid so far. */
+auto decode_sequence(Byte_t const* in, Byte_t const* end, char32_t& out)
+    -> std::size_t
+{
+    auto const lead = in[0];
+    auto length     = std::size_t{0};
+    auto value      = char32_t{0};
+    // Narrowed range of the second byte, rejects overlongs and surrogates.
+    auto low  = Byte_t{0x80};
+    auto high = Byte_t{0xBF};
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        value  = lead & 0x1Fu;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        value  = lead & 0x0Fu;
+        if (lead == 0xE0)
+            low = 0xA0;
+        else if (lead == 0xED)
+            high = 0x9F;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        value  = lead & 0x07u;
+        if (lead == 0xF0)
+            low = 0x90;
+        else if (lead == 0xF4)
+            high = 0x8F;
+    }
+    else {
+        out = replacement;
+        return 1;
+    }
+
+    auto const available = static_cast<std::size_t>(end - in);
+    for (auto i = std::size_t{1}; i < length; ++i) {
+        auto const b = i < available ? in[i] : Byte_t{0};
+        auto const valid =
+            i == 1 ? (b >= low && b <= high) : is_continuation(b);
+        if (!valid) {
+            out = replacement;
+            return i;
         }
+        value = (value << 6) | (b & 0x3Fu);
+    }
+    out = value;
+    return length;
+}
+
+}  // namespace
+
+namespace ox {
+
+auto mb_to_u32(std::string_view sv) -> std::u32string
+{
+    // Each byte produces at most one char32_t.
+    auto result     = std::u32string(sv.size(), U'\0');
+    auto const* in  = reinterpret_cast<Byte_t const*>(sv.data());
+    auto const* end = in + sv.size();
+    auto* out       = result.data();
+    while (in != end) {
+        auto const ascii = copy_ascii(in, end, out);
+        in += ascii;
+        out += ascii;
+        if (in == end)
+            break;
+        in += decode_sequence(in, end, *out++);
     }
-    return buffer.data() == nullptr ? U"" : std::u32string{buffer.data()};
+    result.resize(static_cast<std::size_t>(out - result.data()));
+    return result;
 }
 
 }  // namespace ox
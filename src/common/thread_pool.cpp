@@ -0,0 +1,82 @@
+#include <termox/common/thread_pool.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace ox {
+
+Thread_pool::Thread_pool(std::size_t worker_count)
+{
+    workers_.reserve(worker_count);
+    for (auto i = std::size_t{0}; i < worker_count; ++i)
+        workers_.emplace_back([this] { this->loop_function(); });
+}
+
+Thread_pool::~Thread_pool()
+{
+    {
+        auto const lock = this->Lockable::lock();
+        exit_           = true;
+        batch_ready_.notify_all();
+    }
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+void Thread_pool::run(std::size_t count, Job_t const& job)
+{
+    if (count == 0)
+        return;
+    if (workers_.empty() || count == 1) {
+        for (auto i = std::size_t{0}; i < count; ++i)
+            job(i);
+        return;
+    }
+    {
+        auto const lock = this->Lockable::lock();
+        job_            = &job;
+        count_          = count;
+        next_index_     = 0;
+        busy_workers_   = workers_.size();
+        ++generation_;
+        batch_ready_.notify_all();
+    }
+    this->work();
+    auto lock = std::unique_lock{this->Lockable::mutex()};
+    batch_done_.wait(lock, [this] { return busy_workers_ == 0; });
+    job_ = nullptr;
+}
+
+auto Thread_pool::worker_count() const -> std::size_t
+{
+    return workers_.size();
+}
+
+void Thread_pool::loop_function()
+{
+    auto generation = std::size_t{0};
+    auto lock       = std::unique_lock{this->Lockable::mutex()};
+    while (true) {
+        batch_ready_.wait(
+            lock, [&] { return exit_ || generation_ != generation; });
+        if (exit_)
+            return;
+        generation = generation_;
+        lock.unlock();
+        this->work();
+        lock.lock();
+        if (--busy_workers_ == 0)
+            batch_done_.notify_one();
+    }
+}
+
+void Thread_pool::work()
+{
+    for (auto i = next_index_.fetch_add(1); i < count_;
+         i      = next_index_.fetch_add(1)) {
+        (*job_)(i);
+    }
+}
+
+}  // namespace ox
@@ -1,46 +1,44 @@
 #include <termox/common/u32_to_mb.hpp>
 
-#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
 #include <string>
 #include <string_view>
-#include <vector>
-
-#ifdef __APPLE__
-#    include <cwchar>
-#else
-#    include <cuchar>
-#endif
-
-#include <esc/detail/u32_to_mb.hpp>
 
 namespace ox {
 
+void append_utf8(std::u32string_view sv, std::string& out)
+{
+    // ASCII prefix is copied without encoding or sizing the rest.
+    auto const ascii_end = std::find_if(std::cbegin(sv), std::cend(sv),
+                                        [](char32_t c) { return c >= 0x80; });
+    auto const ascii = static_cast<std::size_t>(ascii_end - std::cbegin(sv));
+
+    auto size = out.size() + ascii;
+    for (auto i = ascii; i < sv.size(); ++i)
+        size += utf8_length(sv[i]);
+
+    auto const start = out.size();
+    out.resize(size);
+    auto* iter = out.data() + start;
+    iter = std::transform(std::cbegin(sv), ascii_end, iter,
+                          [](char32_t c) { return static_cast<char>(c); });
+    for (auto i = ascii; i < sv.size(); ++i)
+        iter += u32_to_utf8(sv[i], iter);
+}
+
 auto u32_to_mb(char32_t c) -> std::string
 {
-    auto [count, chars] = ::esc::detail::u32_to_mb(c);
-    return std::string(chars.data(), count);
+    auto result = std::string(utf8_length(c), '\0');
+    u32_to_utf8(c, result.data());
+    return result;
 }
 
 auto u32_to_mb(std::u32string_view sv) -> std::string
 {
-    auto buffer   = std::vector<char>(sv.size() * 4 + 1, '\0');
-    auto mb_state = std::mbstate_t{};
-    char* out     = buffer.data();
-
-    for (char32_t c : sv) {
-#ifdef __APPLE__
-        static_assert(sizeof(wchar_t) == sizeof(char32_t));
-        static_assert(alignof(wchar_t) == alignof(char32_t));
-        auto const bytes_written =
-            std::wcrtomb(out, static_cast<wchar_t>(c), &mb_state);
-#else
-        auto const bytes_written = std::c32rtomb(out, c, &mb_state);
-#endif
-        if (bytes_written == std::size_t(-1))
-            throw std::runtime_error{"u32_to_mb(): Error."};
-        out += bytes_written;
-    }
-    return buffer.data() == nullptr ? "" : std::string{buffer.data()};
+    auto result = std::string{};
+    append_utf8(sv, result);
+    return result;
 }
 
 }  // namespace ox
@@ -0,0 +1,59 @@
+#include <termox/common/wakeup.hpp>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#    include <sys/eventfd.h>
+#endif
+
+namespace ox {
+
+Wakeup::Wakeup()
+{
+#ifdef __linux__
+    read_fd_  = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    write_fd_ = read_fd_;
+    if (read_fd_ == -1)
+        throw std::runtime_error{"Wakeup: eventfd() failed"};
+#else
+    auto fds = std::array<int, 2>{};
+    if (::pipe(fds.data()) == -1)
+        throw std::runtime_error{"Wakeup: pipe() failed"};
+    for (auto fd : fds) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd_  = fds[0];
+    write_fd_ = fds[1];
+#endif
+}
+
+Wakeup::~Wakeup()
+{
+    ::close(read_fd_);
+    if (write_fd_ != read_fd_)
+        ::close(write_fd_);
+}
+
+void Wakeup::notify()
+{
+    // A full pipe or a saturated eventfd is already readable, so a failed
+    // write can be ignored.
+    auto const one = std::uint64_t{1};
+    [[maybe_unused]] auto const n = ::write(write_fd_, &one, sizeof(one));
+}
+
+void Wakeup::clear()
+{
+    auto buffer = std::array<char, 64>{};
+    while (::read(read_fd_, buffer.data(), buffer.size()) > 0) {}
+}
+
+auto Wakeup::fd() const -> int { return read_fd_; }
+
+}  // namespace ox
@@ -0,0 +1,126 @@
+#include <termox/painter/detail/occlusion.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <termox/painter/detail/is_paintable.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+#include <termox/widget/area.hpp>
+#include <termox/widget/point.hpp>
+#include <termox/widget/widget.hpp>
+
+namespace ox::detail {
+
+auto is_opaque(Widget const& w) -> bool
+{
+    return is_paintable(w) && w.get_wallpaper().symbol != U'\0';
+}
+
+void Coverage_sweep::reset(Widget const& w)
+{
+    auto const top_left = w.top_left();
+    auto const area     = w.area();
+    left_               = top_left.x;
+    right_              = top_left.x + area.width;
+    top_                = top_left.y;
+    end_                = top_left.y + area.height;
+
+    by_top_.clear();
+    for (Widget const& child : w.get_children()) {
+        if (!is_opaque(child))
+            continue;
+        auto const child_top_left = child.top_left();
+        auto const child_area     = child.area();
+        by_top_.push_back({child_top_left.x, child_top_left.y,
+                           child_top_left.x + child_area.width,
+                           child_top_left.y + child_area.height});
+    }
+    std::sort(std::begin(by_top_), std::end(by_top_),
+              [](auto const& a, auto const& b) { return a.top < b.top; });
+    next_child_ = 0;
+    active_.clear();
+    this->find_band();
+}
+
+void Coverage_sweep::next()
+{
+    top_ = bottom_;
+    this->find_band();
+}
+
+void Coverage_sweep::find_band()
+{
+    if (this->done())
+        return;
+
+    active_.erase(std::remove_if(std::begin(active_), std::end(active_),
+                                 [this](auto const& r) {
+                                     return r.bottom <= top_;
+                                 }),
+                  std::end(active_));
+    for (; next_child_ < by_top_.size() && by_top_[next_child_].top <= top_;
+         ++next_child_) {
+        auto const& r = by_top_[next_child_];
+        if (r.bottom <= top_)
+            continue;
+        auto const at = std::upper_bound(
+            std::begin(active_), std::end(active_), r,
+            [](auto const& a, auto const& b) { return a.left < b.left; });
+        active_.insert(at, r);
+    }
+
+    // The band ends where the next child starts or an active child ends.
+    bottom_ = end_;
+    if (next_child_ < by_top_.size())
+        bottom_ = std::min(bottom_, by_top_[next_child_].top);
+    for (auto const& r : active_)
+        bottom_ = std::min(bottom_, r.bottom);
+
+    uncovered_.clear();
+    auto x = left_;
+    for (auto const& r : active_) {
+        if (x >= right_)
+            break;
+        if (r.left > x)
+            uncovered_.push_back({x, std::min(r.left, right_)});
+        x = std::max(x, r.right);
+    }
+    if (x < right_)
+        uncovered_.push_back({x, right_});
+}
+
+auto is_hidden(Widget const& w) -> bool
+{
+    auto const top_left = w.top_left();
+    auto const area     = w.area();
+
+    // Clipped by ancestors.
+    auto left   = top_left.x;
+    auto top    = top_left.y;
+    auto right  = top_left.x + area.width;
+    auto bottom = top_left.y + area.height;
+    for (auto* p = w.parent(); p != nullptr; p = p->parent()) {
+        auto const p_top_left = p->top_left();
+        auto const p_area     = p->area();
+        left   = std::max(left, p_top_left.x);
+        top    = std::max(top, p_top_left.y);
+        right  = std::min(right, p_top_left.x + p_area.width);
+        bottom = std::min(bottom, p_top_left.y + p_area.height);
+        if (left >= right || top >= bottom)
+            return true;
+    }
+
+    // Covered by children.
+    if (w.child_count() == 0)
+        return false;
+    // Reused across calls so the scratch space is only allocated once.
+    thread_local auto sweep = Coverage_sweep{};
+    for (sweep.reset(w); !sweep.done(); sweep.next()) {
+        if (!sweep.uncovered().empty())
+            return false;
+    }
+    return true;
+}
+
+}  // namespace ox::detail
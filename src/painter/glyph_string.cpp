@@ -1,6 +1,7 @@
 #include <termox/painter/glyph_string.hpp>
 
 #include <algorithm>
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -46,7 +47,14 @@ auto Glyph_string::u32str() const -> std::u32string
 
 auto Glyph_string::str() const -> std::string
 {
-    return u32_to_mb(this->u32str());
+    auto size = std::size_t{0};
+    for (Glyph g : *this)
+        size += utf8_length(g.symbol);
+    auto result = std::string(size, '\0');
+    auto* iter  = result.data();
+    for (Glyph g : *this)
+        iter += u32_to_utf8(g.symbol, iter);
+    return result;
 }
 
 void Glyph_string::add_traits(Traits traits)
@@ -1,5 +1,9 @@
 #include <termox/painter/painter.hpp>
 
+#include <algorithm>
+#include <vector>
+
+#include <termox/painter/detail/occlusion.hpp>
 #include <termox/painter/glyph_string.hpp>
 #include <termox/system/event_loop.hpp>
 #include <termox/system/system.hpp>
@@ -10,11 +14,22 @@
 namespace ox {
 
 Painter::Painter(Widget& widg, detail::Canvas& canvas)
-    : widget_{widg}, canvas_{canvas}, brush_{widg.brush}
+    : Painter{widg, canvas, widg.top_left()}
+{}
+
+Painter::Painter(Widget& widg, detail::Canvas& canvas, Point origin)
+    : widget_{widg}, canvas_{canvas}, origin_{origin}, brush_{widg.brush}
 {
     this->wallpaper_fill();
 }
 
+Painter::Painter(Widget& widg, detail::Canvas& canvas, Skip_wallpaper)
+    : widget_{widg},
+      canvas_{canvas},
+      origin_{widg.top_left()},
+      brush_{widg.brush}
+{}
+
 auto Painter::put(Glyph tile, Point p) -> Painter&
 {
     // User code can contain invalid points.
@@ -22,58 +37,97 @@ auto Painter::put(Glyph tile, Point p) -> Painter&
         p.x < 0 || p.y < 0) {
         return *this;
     }
-    this->put_global(tile, widget_.top_left() + p);
+    this->put_global(tile, origin_ + p);
     return *this;
 }
 
 auto Painter::put(Glyph_string const& text, Point p) -> Painter&
 {
-    for (Glyph g : text)
-        this->put(g, {p.x++, p.y});
+    auto const area = widget_.area();
+    if (p.y < 0 || p.y >= area.height)
+        return *this;
+    auto const size  = static_cast<int>(text.size());
+    auto const begin = std::max(0, -p.x);
+    auto const end   = std::min(size, area.width - p.x);
+    auto const left  = origin_;
+    for (auto i = begin; i < end; ++i)
+        this->put_global(text[i], {left.x + p.x + i, left.y + p.y});
     return *this;
 }
 
 auto Painter::at(Point p) const -> Glyph
 {
-    auto const global = p + widget_.top_left();
+    auto const global = p + origin_;
     return canvas_.at(global);
 }
 
 auto Painter::at(Point p) -> Glyph&
 {
-    auto const global = p + widget_.top_left();
+    auto const global = p + origin_;
     return canvas_.at(global);
 }
 
 auto Painter::fill(Glyph tile, Point point, Area area) -> Painter&
 {
-    if (area.width == 0)
+    auto const bounds  = widget_.area();
+    auto const x_begin = std::max(point.x, 0);
+    auto const x_end   = std::min(point.x + area.width, bounds.width);
+    auto const y_begin = std::max(point.y, 0);
+    auto const y_end   = std::min(point.y + area.height, bounds.height);
+    if (x_begin >= x_end || y_begin >= y_end)
         return *this;
-    auto const y_limit = point.y + area.height;
-    auto const x_limit = point.x + area.width - 1;  // Used in inclusive context
-    for (; point.y < y_limit; ++point.y)
-        this->hline(tile, point, {x_limit, point.y});
+    tile.brush = merge(tile.brush, brush_);
+    this->fill_global_no_brush(
+        tile, origin_ + Point{x_begin, y_begin},
+        {x_end - x_begin, y_end - y_begin});
     return *this;
 }
 
 auto Painter::hline(Glyph tile, Point a, Point b) -> Painter&
 {
-    for (; a.x <= b.x; ++a.x)
-        this->put(tile, a);
+    auto const bounds = widget_.area();
+    if (a.y < 0 || a.y >= bounds.height)
+        return *this;
+    auto const x_begin = std::max(a.x, 0);
+    auto const x_end   = std::min(b.x + 1, bounds.width);
+    if (x_begin >= x_end)
+        return *this;
+    tile.brush = merge(tile.brush, brush_);
+    canvas_.fill_row(origin_ + Point{x_begin, a.y},
+                     x_end - x_begin, tile);
     return *this;
 }
 
 auto Painter::vline(Glyph tile, Point a, Point b) -> Painter&
 {
-    for (; a.y <= b.y; ++a.y)
-        this->put(tile, a);
+    auto const bounds = widget_.area();
+    if (a.x < 0 || a.x >= bounds.width)
+        return *this;
+    auto const y_begin = std::max(a.y, 0);
+    auto const y_end   = std::min(b.y + 1, bounds.height);
+    if (y_begin >= y_end)
+        return *this;
+    auto const left = origin_;
+    tile.brush      = merge(tile.brush, brush_);
+    for (auto y = y_begin; y < y_end; ++y)
+        canvas_.at({left.x + a.x, left.y + y}) = tile;
     return *this;
 }
 
 auto Painter::wallpaper_fill() -> Painter&
 {
-    this->fill_global_no_brush(widget_.generate_wallpaper(), widget_.top_left(),
-                               widget_.area());
+    // Cells under opaque children are painted over by their own wallpaper.
+    thread_local auto sweep = detail::Coverage_sweep{};
+    auto const wallpaper    = widget_.generate_wallpaper();
+    auto const offset       = origin_ - widget_.top_left();
+    for (sweep.reset(widget_); !sweep.done(); sweep.next()) {
+        for (auto y = sweep.top(); y < sweep.bottom(); ++y) {
+            for (auto const& span : sweep.uncovered()) {
+                canvas_.fill_row({span.begin + offset.x, y + offset.y},
+                                 span.end - span.begin, wallpaper);
+            }
+        }
+    }
     return *this;
 }
 
@@ -87,40 +141,33 @@ void Painter::put_global(Glyph tile, Point p)
 
 void Painter::hline_global(Glyph tile, Point a, Point b)
 {
-    for (; a.x <= b.x; ++a.x)
-        this->put_global(tile, a);
+    tile.brush = merge(tile.brush, brush_);
+    this->hline_global_no_brush(tile, a, b);
 }
 
 void Painter::hline_global_no_brush(Glyph tile, Point a, Point b)
 {
-    for (; a.x <= b.x; ++a.x)
-        canvas_.at(a) = tile;
+    canvas_.fill_row(a, b.x - a.x + 1, tile);
 }
 
 void Painter::vline_global(Glyph tile, Point a, Point b)
 {
+    tile.brush = merge(tile.brush, brush_);
     for (; a.y <= b.y; ++a.y)
-        this->put_global(tile, a);
+        canvas_.at(a) = tile;
 }
 
 void Painter::fill_global(Glyph tile, Point point, Area area)
 {
-    if (area.width == 0)
-        return;
-    auto const y_limit = point.y + area.height;
-    auto const x_limit = point.x + area.width - 1;  // Used in inclusive context
-    for (; point.y < y_limit; ++point.y)
-        this->hline_global(tile, point, {x_limit, point.y});
+    tile.brush = merge(tile.brush, brush_);
+    this->fill_global_no_brush(tile, point, area);
 }
 
 void Painter::fill_global_no_brush(Glyph tile, Point point, Area area)
 {
-    if (area.width == 0)
-        return;
     auto const y_limit = point.y + area.height;
-    auto const x_limit = point.x + area.width - 1;  // Used in inclusive context
     for (; point.y < y_limit; ++point.y)
-        this->hline_global_no_brush(tile, point, {x_limit, point.y});
+        canvas_.fill_row(point, area.width, tile);
 }
 
 }  // namespace ox
@@ -7,6 +7,7 @@
 
 #include <termox/painter/color.hpp>
 #include <termox/painter/detail/is_paintable.hpp>
+#include <termox/painter/detail/occlusion.hpp>
 #include <termox/painter/painter.hpp>
 #include <termox/system/detail/focus.hpp>
 #include <termox/system/event.hpp>
@@ -36,11 +37,27 @@ namespace ox::detail {
 
 void send(ox::Paint_event e)
 {
-    if (!is_paintable(e.receiver))
+    auto& w = e.receiver.get();
+    if (!is_paintable(w) || is_hidden(w))
         return;
-    auto p = Painter{e.receiver, ox::Terminal::screen_buffers.next};
-    e.receiver.get().paint_event(p);
-    e.receiver.get().painted.emit(p);
+    auto& screen = ox::Terminal::screen_buffers.next;
+    if (!w.has_paint_cache()) {
+        auto p = Painter{w, screen};
+        w.paint_event(p);
+        w.painted.emit(p);
+        return;
+    }
+    auto const* cache = w.valid_paint_cache();
+    if (cache == nullptr) {
+        auto* const fresh = w.reset_paint_cache();
+        auto p            = Painter{w, *fresh, {0, 0}};
+        w.paint_event(p);
+        cache = fresh;
+    }
+    screen.blit(*cache, w.top_left());
+    // Slots are not cached, they paint over the cached Glyphs every time.
+    auto p = Painter{w, screen, Painter::Skip_wallpaper{}};
+    w.painted.emit(p);
 }
 
 void send(ox::Key_press_event e)
@@ -74,8 +91,10 @@ void send(ox::Mouse_release_event e)
 
 void send(ox::Mouse_wheel_event e)
 {
-    e.receiver.get().mouse_wheel_event(e.data);
-    e.receiver.get().mouse_wheel_scrolled.emit(e.data);
+    for (auto i = 0; i < e.count; ++i) {
+        e.receiver.get().mouse_wheel_event(e.data);
+        e.receiver.get().mouse_wheel_scrolled.emit(e.data);
+    }
 }
 
 void send(ox::Mouse_move_event e)
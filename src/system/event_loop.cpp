@@ -1,5 +1,9 @@
 #include <termox/system/event_loop.hpp>
 
+#include <utility>
+
+#include <termox/system/event.hpp>
+
 namespace ox {
 
 void Event_loop::exit(int return_code)
@@ -15,6 +19,14 @@ auto Event_loop::wait() -> int
     return fut_.get();
 }
 
+void Event_loop::post(Event e)
+{
+    posted_.push(std::move(e));
+    wakeup_.notify();
+}
+
+auto Event_loop::wakeup_fd() const -> int { return wakeup_.fd(); }
+
 auto Event_loop::is_running() const -> bool { return running_; }
 
 auto Event_loop::exit_flag() const -> bool { return exit_; }
@@ -23,4 +35,11 @@ auto Event_loop::event_queue() -> Event_queue& { return queue_; }
 
 auto Event_loop::event_queue() const -> Event_queue const& { return queue_; }
 
+void Event_loop::take_posted()
+{
+    wakeup_.clear();
+    while (auto e = posted_.pop())
+        queue_.append(std::move(*e));
+}
+
 }  // namespace ox
@@ -1,45 +1,180 @@
 #include <termox/system/event_queue.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <utility>
 #include <variant>
 
+#include <termox/common/thread_pool.hpp>
+#include <termox/painter/detail/is_paintable.hpp>
+#include <termox/painter/detail/occlusion.hpp>
 #include <termox/system/event.hpp>
 #include <termox/system/system.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+#include <termox/terminal/detail/screen_buffers.hpp>
 #include <termox/terminal/terminal.hpp>
 #include <termox/widget/widget.hpp>
 
-namespace ox {
+namespace {
 
-auto operator<(Paint_event const& x, Paint_event const& y) -> bool
+/// Return a Paint_queue batch generation that has not been returned before.
+/** Starts at one, Widgets start out stamped with zero. */
+[[nodiscard]] auto next_paint_generation() -> std::uint64_t
 {
-    return std::addressof(x.receiver.get()) < std::addressof(y.receiver.get());
+    static auto generation = std::atomic<std::uint64_t>{0};
+    return generation.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
-auto operator==(Paint_event const& a, Paint_event const& b) -> bool
+/// Return true if the screen areas of \p a and \p b share any cell.
+[[nodiscard]] auto overlaps(ox::Widget const& a, ox::Widget const& b) -> bool
 {
-    return std::addressof(a.receiver.get()) == std::addressof(b.receiver.get());
+    auto const a_left = a.top_left();
+    auto const b_left = b.top_left();
+    return a_left.x < b_left.x + b.area().width &&
+           b_left.x < a_left.x + a.area().width &&
+           a_left.y < b_left.y + b.area().height &&
+           b_left.y < a_left.y + a.area().height;
 }
 
-}  // namespace ox
+/// Return true if \p a and \p b have the same button and modifier keys.
+[[nodiscard]] auto same_buttons(ox::Mouse const& a, ox::Mouse const& b) -> bool
+{
+    return a.button == b.button && a.modifiers.shift == b.modifiers.shift &&
+           a.modifiers.ctrl == b.modifiers.ctrl &&
+           a.modifiers.alt == b.modifiers.alt;
+}
+
+}  // namespace
 
 namespace ox::detail {
 
-void Paint_queue::append(Paint_event e) { events_.append(e); }
+void Paint_groups::assign(std::vector<Paint_event> const& events)
+{
+    auto const count = events.size();
+    roots_.resize(count);
+    std::iota(std::begin(roots_), std::end(roots_), std::size_t{0});
+    auto const widget = [&events](std::size_t i) -> Widget const& {
+        return events[i].receiver.get();
+    };
+    auto const bottom = [&](std::size_t i) {
+        return widget(i).top_left().y + widget(i).area().height;
+    };
+
+    // Only receivers still active at a receiver's top row can overlap it.
+    order_.resize(count);
+    std::iota(std::begin(order_), std::end(order_), std::size_t{0});
+    std::sort(std::begin(order_), std::end(order_),
+              [&](std::size_t a, std::size_t b) {
+                  return widget(a).top_left().y < widget(b).top_left().y;
+              });
+    active_.clear();
+    for (auto const i : order_) {
+        auto const top = widget(i).top_left().y;
+        active_.erase(std::remove_if(std::begin(active_), std::end(active_),
+                                     [&](auto j) { return bottom(j) <= top; }),
+                      std::end(active_));
+        for (auto const j : active_) {
+            if (overlaps(widget(i), widget(j))) {
+                auto const a = this->find(i);
+                auto const b = this->find(j);
+                roots_[std::max(a, b)] = std::min(a, b);
+            }
+        }
+        active_.push_back(i);
+    }
+
+    // Each group is a contiguous range of order_, in queue order.
+    std::iota(std::begin(order_), std::end(order_), std::size_t{0});
+    for (auto i = std::size_t{0}; i < count; ++i)
+        roots_[i] = this->find(i);
+    std::stable_sort(
+        std::begin(order_), std::end(order_),
+        [this](std::size_t a, std::size_t b) { return roots_[a] < roots_[b]; });
+    ranges_.clear();
+    for (auto i = std::size_t{0}; i < count; ++i) {
+        if (i == 0 || roots_[order_[i]] != roots_[order_[i - 1]])
+            ranges_.push_back({i, i});
+        ++ranges_.back().second;
+    }
+}
+
+auto Paint_groups::find(std::size_t i) -> std::size_t
+{
+    while (roots_[i] != i)
+        i = roots_[i] = roots_[roots_[i]];
+    return i;
+}
+
+Paint_queue::Paint_queue() : generation_{next_paint_generation()} {}
+
+void Paint_queue::append(Paint_event e)
+{
+    if (e.receiver.get().stamp_paint(generation_))
+        events_.push_back(e);
+}
 
 auto Paint_queue::send_all() -> bool
 {
-    events_.compress();
     /// Processing Paint_events should not post more Paint_events.
+    auto* const pool = System::paint_pool();
+    auto const sent =
+        pool == nullptr ? this->send_serial() : this->send_parallel(*pool);
+    events_.clear();
+    generation_ = next_paint_generation();
+    return sent;
+}
+
+auto Paint_queue::send_serial() -> bool
+{
     bool sent = false;
     for (auto& p : events_)
         sent = System::send_event(std::move(p)) || sent;
-    events_.clear();
     return sent;
 }
 
+auto Paint_queue::send_parallel(Thread_pool& pool) -> bool
+{
+    // Receivers that paint nothing are sent first, only filters can paint.
+    bool sent = false;
+    visible_.clear();
+    for (auto& p : events_) {
+        auto const& w = p.receiver.get();
+        if (is_paintable(w) && !is_hidden(w))
+            visible_.push_back(p);
+        else
+            sent = System::send_event(std::move(p)) || sent;
+    }
+    if (visible_.empty())
+        return sent;
+
+    groups_.assign(visible_);
+
+    // Dirty spans are marked up front, threads then write without recording.
+    auto& next = Terminal::screen_buffers.next;
+    for (auto const& p : visible_) {
+        auto const& w = p.receiver.get();
+        next.mark_dirty_area(w.top_left(), w.area());
+    }
+    next.set_write_tracking(false);
+    auto any_sent = std::atomic<bool>{false};
+    pool.run(groups_.size(), [&](std::size_t g) {
+        groups_.for_each(g, [&](std::size_t i) {
+            if (System::send_event(visible_[i]))
+                any_sent = true;
+        });
+    });
+    next.set_write_tracking(true);
+    visible_.clear();
+    return sent || any_sent;
+}
+
 auto Paint_queue::size() const -> std::size_t { return events_.size(); }
 
 void Delete_queue::append(Delete_event e) { deletes_.push_back(std::move(e)); }
@@ -56,17 +191,102 @@ auto Delete_queue::size() const -> std::size_t { return deletes_.size(); }
 
 void Basic_queue::append(Event e) { basics_.push_back(std::move(e)); }
 
+void Basic_queue::append(Move_event e)
+{
+    auto const [at, inserted] =
+        moves_.try_emplace(&e.receiver.get(), basics_.size());
+    if (!inserted && at->second >= next_) {
+        std::get<Move_event>(basics_[at->second]).new_position =
+            e.new_position;
+        return;
+    }
+    at->second = basics_.size();
+    basics_.push_back(std::move(e));
+}
+
+void Basic_queue::append(Resize_event e)
+{
+    auto const [at, inserted] =
+        resizes_.try_emplace(&e.receiver.get(), basics_.size());
+    if (!inserted && at->second >= next_) {
+        std::get<Resize_event>(basics_[at->second]).new_area = e.new_area;
+        return;
+    }
+    at->second = basics_.size();
+    basics_.push_back(std::move(e));
+}
+
+void Basic_queue::append(Child_polished_event e)
+{
+    auto const key = std::pair<Widget const*, Widget const*>{
+        &e.receiver.get(), &e.child.get()};
+    auto const [at, inserted] = polishes_.try_emplace(key, basics_.size());
+    if (!inserted && at->second >= next_)
+        return;
+    at->second = basics_.size();
+    basics_.push_back(std::move(e));
+}
+
+template <typename T>
+auto Basic_queue::waiting_back() -> T*
+{
+    if (basics_.size() <= next_)
+        return nullptr;
+    return std::get_if<T>(&basics_.back());
+}
+
+void Basic_queue::append(Mouse_move_event e)
+{
+    auto* const back = this->waiting_back<Mouse_move_event>();
+    if (back != nullptr && !e.receiver.get().has_raw_mouse_input() &&
+        &back->receiver.get() == &e.receiver.get() &&
+        same_buttons(back->data, e.data)) {
+        back->data = e.data;
+        return;
+    }
+    basics_.push_back(std::move(e));
+}
+
+void Basic_queue::append(Mouse_wheel_event e)
+{
+    auto* const back = this->waiting_back<Mouse_wheel_event>();
+    if (back != nullptr && !e.receiver.get().has_raw_mouse_input() &&
+        &back->receiver.get() == &e.receiver.get() &&
+        back->data.at == e.data.at && same_buttons(back->data, e.data)) {
+        back->count += e.count;
+        return;
+    }
+    basics_.push_back(std::move(e));
+}
+
 auto Basic_queue::send_all() -> bool
 {
     // Allows for send(e) appending to the queue and invalidating iterators.
     bool sent = false;
-    for (auto index = 0uL; index < basics_.size(); ++index)
+    while (next_ < basics_.size()) {
+        auto const index = next_++;
         sent = System::send_event(std::move(basics_[index])) || sent;
+    }
     basics_.clear();
+    next_ = 0;
+    moves_.clear();
+    resizes_.clear();
+    polishes_.clear();
     return sent;
 }
 
-auto Basic_queue::size() const -> std::size_t { return basics_.size(); }
+auto Basic_queue::size() const -> std::size_t
+{
+    return basics_.size() - next_;
+}
+
+auto Basic_queue::Pair_hash::operator()(
+    std::pair<Widget const*, Widget const*> p) const -> std::size_t
+{
+    auto const a = std::hash<Widget const*>{}(p.first);
+    auto const b = std::hash<Widget const*>{}(p.second);
+    return a ^ (b + 0x9e3779b9 + (a << 6) + (a >> 2));
+}
 
 }  // namespace ox::detail
 
@@ -84,21 +304,24 @@ void Event_queue::append(Event e)
 void Event_queue::send_all()
 {
     // If widget tree has not been fully created yet, then do not process events
-    // this prevents set_current_queue() from being called, while widget
-    // constructors are still posting to the System::current_queue_, which
-    // should be the user input event loop at construction. Prevents async loops
-    // like the animation engine from assigning to current_queue during Widget
-    // tree construction.
+    // this prevents async loops like the animation engine from sending Events
+    // to Widgets that are still under construction.
     if (System::head() == nullptr)
         return;
-    static auto mtx = std::mutex{};
-    auto const lock = std::lock_guard{mtx};
-    System::set_current_queue(*this);
+    auto const lock = std::lock_guard{Event_queue::mutex()};
+    System::set_current_queue(this);
     bool sent = basics_.send_all();
     sent      = paints_.send_all() || sent;
     deletes_.send_all();
+    System::set_current_queue(nullptr);
     if (sent)
-        Terminal::flush_screen();
+        System::request_present();
+}
+
+auto Event_queue::mutex() -> std::mutex&
+{
+    static auto mtx = std::mutex{};
+    return mtx;
 }
 
 void Event_queue::add_to_a_queue(Paint_event e)
@@ -0,0 +1,103 @@
+#include <termox/system/render_engine.hpp>
+
+#include <mutex>
+#include <thread>
+
+#include <termox/common/fps.hpp>
+#include <termox/system/event.hpp>
+#include <termox/system/event_queue.hpp>
+#include <termox/terminal/terminal.hpp>
+
+namespace {
+
+/// Write the staged changes to the terminal, excluding Event processing.
+void present()
+{
+    auto const lock = std::scoped_lock{ox::Event_queue::mutex()};
+    ox::Terminal::flush_screen();
+}
+
+}  // namespace
+
+namespace ox {
+
+void Render_engine::set_fps(FPS fps)
+{
+    this->set_interval(fps_to_period<Duration_t>(fps));
+}
+
+void Render_engine::set_interval(Duration_t interval)
+{
+    auto const lock = this->Lockable::lock();
+    interval_       = interval;
+    condition_.notify_one();
+}
+
+auto Render_engine::get_interval() const -> Duration_t
+{
+    auto const lock = this->Lockable::lock();
+    return interval_;
+}
+
+void Render_engine::request_present()
+{
+    if (!this->is_running()) {
+        Terminal::flush_screen();
+        return;
+    }
+    auto const lock = this->Lockable::lock();
+    pending_        = true;
+    condition_.notify_one();
+}
+
+void Render_engine::present_now()
+{
+    auto const lock = this->Lockable::lock();
+    pending_        = true;
+    immediate_      = true;
+    condition_.notify_one();
+}
+
+void Render_engine::start()
+{
+    if (this->is_running())
+        return;
+    exit_   = false;
+    thread_ = std::thread{[this] { this->loop_function(); }};
+}
+
+void Render_engine::stop()
+{
+    if (!this->is_running())
+        return;
+    {
+        auto const lock = this->Lockable::lock();
+        exit_           = true;
+        condition_.notify_one();
+    }
+    thread_.join();
+}
+
+auto Render_engine::is_running() const -> bool { return thread_.joinable(); }
+
+void Render_engine::loop_function()
+{
+    auto lock = std::unique_lock{this->Lockable::mutex()};
+    while (!exit_) {
+        condition_.wait(lock, [this] { return pending_ || exit_; });
+        // Requests made while waiting out the interval join this frame.
+        condition_.wait_until(lock, last_present_ + interval_,
+                              [this] { return immediate_ || exit_; });
+        // A request pending at exit is still presented, so no frame is lost.
+        if (!pending_)
+            continue;
+        pending_   = false;
+        immediate_ = false;
+        lock.unlock();
+        present();
+        lock.lock();
+        last_present_ = Clock_t::now();
+    }
+}
+
+}  // namespace ox
@@ -1,12 +1,16 @@
 #include <termox/system/system.hpp>
 
+#include <cstddef>
 #include <cstdlib>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <variant>
 
 #include <signals_light/signal.hpp>
 
+#include <termox/common/fps.hpp>
+#include <termox/common/thread_pool.hpp>
 #include <termox/system/animation_engine.hpp>
 #include <termox/system/detail/filter_send.hpp>
 #include <termox/system/detail/focus.hpp>
@@ -17,11 +21,13 @@
 #include <termox/system/event.hpp>
 #include <termox/system/event_loop.hpp>
 #include <termox/system/event_queue.hpp>
+#include <termox/system/render_engine.hpp>
 #include <termox/system/system.hpp>
 #include <termox/terminal/key_mode.hpp>
 #include <termox/terminal/mouse_mode.hpp>
 #include <termox/terminal/signals.hpp>
 #include <termox/terminal/terminal.hpp>
+#include <termox/terminal/terminal_sink.hpp>
 #include <termox/widget/area.hpp>
 #include <termox/widget/widget.hpp>
 
@@ -32,6 +38,8 @@ System::System(Mouse_mode mouse_mode, Key_mode key_mode, Signals signals)
     Terminal::initialize(mouse_mode, key_mode, signals);
 }
 
+System::System(Terminal_sink& sink) { Terminal::initialize(sink); }
+
 System::~System() { System::exit(); }
 
 auto System::focus_widget() -> Widget* { return detail::Focus::focus_widget(); }
@@ -69,9 +77,11 @@ auto System::run() -> int
     auto* const head = head_.load();
     if (head == nullptr)
         return -1;
+    render_engine_.start();
     auto const result = user_input_loop_.run();
     // user_input_loop_ is already stopped if you are here.
     animation_engine_.stop();
+    render_engine_.stop();
     Terminal::stop_dynamic_color_engine();
     return result;
 }
@@ -109,7 +119,13 @@ auto System::send_event(Delete_event e) -> bool
     return true;
 }
 
-void System::post_event(Event e) { current_queue_.get().append(std::move(e)); }
+void System::post_event(Event e)
+{
+    if (current_queue_ != nullptr)
+        current_queue_->append(std::move(e));
+    else
+        user_input_loop_.post(std::move(e));
+}
 
 void System::exit()
 {
@@ -137,6 +153,31 @@ void System::disable_animation(Widget& w)
     animation_engine_.unregister_widget(w);
 }
 
+void System::set_max_fps(FPS fps) { render_engine_.set_fps(fps); }
+
+void System::present_now() { render_engine_.present_now(); }
+
+void System::set_paint_threads(std::size_t threads)
+{
+    paint_threads_ = threads;
+}
+
+auto System::paint_pool() -> Thread_pool*
+{
+    // Swapped here, between batches, so a pool is never replaced while it is
+    // painting, and set_paint_threads() can be called from an Event handler.
+    // The Event_loop's thread paints alongside the workers.
+    auto const threads = paint_threads_.load();
+    auto const workers = threads < 2 ? 0 : threads - 1;
+    if (workers == 0)
+        paint_pool_ = nullptr;
+    else if (paint_pool_ == nullptr || paint_pool_->worker_count() != workers)
+        paint_pool_ = std::make_unique<Thread_pool>(workers);
+    return paint_pool_.get();
+}
+
+void System::request_present() { render_engine_.request_present(); }
+
 void System::set_cursor(Cursor cursor, Point offset)
 {
     if (!cursor.is_enabled())
@@ -148,13 +189,13 @@ void System::set_cursor(Cursor cursor, Point offset)
     }
 }
 
-void System::set_current_queue(Event_queue& queue) { current_queue_ = queue; }
+void System::set_current_queue(Event_queue* queue) { current_queue_ = queue; }
 
 sl::Slot<void()> System::quit = [] { System::exit(); };
 
 detail::User_input_event_loop System::user_input_loop_;
 Animation_engine System::animation_engine_;
-std::reference_wrapper<Event_queue> System::current_queue_ =
-    user_input_loop_.event_queue();
+Render_engine System::render_engine_;
+std::unique_ptr<Thread_pool> System::paint_pool_ = nullptr;
 
 }  // namespace ox
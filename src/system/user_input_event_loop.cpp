@@ -1,20 +1,44 @@
 #include <termox/system/detail/user_input_event_loop.hpp>
 
+#include <utility>
+
 #include <termox/system/event.hpp>
 #include <termox/system/event_queue.hpp>
 #include <termox/terminal/terminal.hpp>
 #include <termox/widget/widget.hpp>
 
+namespace {
+
+/// Most Events read into one batch, so a flood of input still gets painted.
+constexpr auto max_batch_size = 1'024;
+
+}  // namespace
+
 namespace ox::detail {
 
 auto User_input_event_loop::run() -> int
 {
-    return loop_.run(
-        [](Event_queue& q) { q.append(ox::Terminal::read_input()); });
+    return loop_.run([this](Event_queue& q) {
+        // A post() from another thread ends the wait without reading input.
+        if (!ox::Terminal::wait_for_input(loop_.wakeup_fd()))
+            return;
+        q.append(ox::Terminal::read_input());
+        // Everything already readable is sent in the same batch, so bursts of
+        // typing or mouse motion are painted once. A lone key is not delayed,
+        // nothing else is waiting and the batch is sent right away.
+        for (auto count = 1; count < max_batch_size; ++count) {
+            auto e = ox::Terminal::read_pending_input();
+            if (!e)
+                break;
+            q.append(std::move(*e));
+        }
+    });
 }
 
 void User_input_event_loop::exit(int exit_code) { loop_.exit(exit_code); }
 
+void User_input_event_loop::post(Event e) { loop_.post(std::move(e)); }
+
 auto User_input_event_loop::event_queue() -> Event_queue&
 {
     return loop_.event_queue();
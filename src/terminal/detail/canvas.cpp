@@ -2,14 +2,25 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#    define TERMOX_X86_KERNELS
+#    include <immintrin.h>
+#endif
+
 #include <termox/painter/brush.hpp>
 #include <termox/painter/color.hpp>
 #include <termox/painter/glyph.hpp>
+#include <termox/terminal/detail/color_usage.hpp>
 #include <termox/widget/area.hpp>
 #include <termox/widget/point.hpp>
 
@@ -29,11 +40,229 @@ namespace {
     return (p.x < a.width) && (p.y < a.height);
 }
 
+/// Grow \p span so that it includes \p i.
+void extend(ox::detail::Canvas::Span& span, int i)
+{
+    if (span.begin >= span.end)
+        span = {i, i + 1};
+    else {
+        span.begin = std::min(span.begin, i);
+        span.end   = std::max(span.end, i + 1);
+    }
+}
+
+using ox::detail::Canvas;
+using ox::detail::Color_usage;
+using ox::detail::Merge_kernel;
+
+// The kernels compare whole Glyphs as 8 byte values, with the symbol in the
+// low four bytes. This relies on Glyph having no padding bytes.
+static_assert(sizeof(ox::Glyph) == 8);
+static_assert(alignof(ox::Glyph) == 4);
+
+/// Merges a row of \p count Glyphs from \p next into \p current.
+/** \p at is the Point of the first Glyph. Changes are appended to \p diff_out
+ *  and recorded in \p usage if they are not nullptr. */
+using Row_kernel = void (*)(ox::Glyph const* next,
+                            ox::Glyph* current,
+                            int count,
+                            ox::Point at,
+                            Canvas::Diff* diff_out,
+                            Color_usage* usage);
+
+void merge_row_scalar(ox::Glyph const* next,
+                      ox::Glyph* current,
+                      int count,
+                      ox::Point at,
+                      Canvas::Diff* diff_out,
+                      Color_usage* usage)
+{
+    for (auto i = 0; i < count; ++i) {
+        if (next[i].symbol != U'\0' && next[i] != current[i]) {
+            if (usage != nullptr)
+                usage->replace(current[i], next[i], {at.x + i, at.y});
+            current[i] = next[i];
+            if (diff_out != nullptr)
+                diff_out->push_back({{at.x + i, at.y}, next[i]});
+        }
+    }
+}
+
+#ifdef TERMOX_X86_KERNELS
+
+/// Copy each Glyph flagged in \p lanes from \p next to \p current.
+/** Bit n of \p lanes refers to the Glyph at index + n. */
+void merge_lanes(unsigned lanes,
+                 ox::Glyph const* next,
+                 ox::Glyph* current,
+                 int index,
+                 ox::Point at,
+                 Canvas::Diff* diff_out,
+                 Color_usage* usage)
+{
+    for (; lanes != 0; lanes &= lanes - 1) {
+        auto const i = index + __builtin_ctz(lanes);
+        if (usage != nullptr)
+            usage->replace(current[i], next[i], {at.x + i, at.y});
+        current[i] = next[i];
+        if (diff_out != nullptr)
+            diff_out->push_back({{at.x + i, at.y}, next[i]});
+    }
+}
+
+/// Two Glyphs per iteration, SSE2 is always available on x86-64.
+__attribute__((target("sse2"))) void merge_row_sse2(ox::Glyph const* next,
+                                                    ox::Glyph* current,
+                                                    int count,
+                                                    ox::Point at,
+                                                    Canvas::Diff* diff_out,
+                                                    Color_usage* usage)
+{
+    auto const zero = _mm_setzero_si128();
+    auto i          = 0;
+    for (; i + 2 <= count; i += 2) {
+        auto const n =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(next + i));
+        auto const c =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(current + i));
+        // One bit per four bytes; bits 0 and 2 are symbols, 1 and 3 Brushes.
+        auto const equal =
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(n, c)));
+        auto const null =
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(n, zero)));
+        auto lanes = 0u;
+        if ((equal & 0b0011) != 0b0011 && (null & 0b0001) == 0)
+            lanes |= 0b01;
+        if ((equal & 0b1100) != 0b1100 && (null & 0b0100) == 0)
+            lanes |= 0b10;
+        if (lanes != 0)
+            merge_lanes(lanes, next, current, i, at, diff_out, usage);
+    }
+    merge_row_scalar(next + i, current + i, count - i, {at.x + i, at.y},
+                     diff_out, usage);
+}
+
+/// Four Glyphs per iteration.
+__attribute__((target("avx2"))) void merge_row_avx2(ox::Glyph const* next,
+                                                    ox::Glyph* current,
+                                                    int count,
+                                                    ox::Point at,
+                                                    Canvas::Diff* diff_out,
+                                                    Color_usage* usage)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto i          = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto const n =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(next + i));
+        auto const c =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(current + i));
+        auto const equal = _mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpeq_epi64(n, c)));
+        // Shift each symbol's compare result into the sign bit of its Glyph.
+        auto const null = _mm256_movemask_pd(_mm256_castsi256_pd(
+            _mm256_slli_epi64(_mm256_cmpeq_epi32(n, zero), 32)));
+        auto const lanes = ~static_cast<unsigned>(equal | null) & 0b1111u;
+        if (lanes != 0)
+            merge_lanes(lanes, next, current, i, at, diff_out, usage);
+    }
+    merge_row_scalar(next + i, current + i, count - i, {at.x + i, at.y},
+                     diff_out, usage);
+}
+
+#endif  // TERMOX_X86_KERNELS
+
+[[nodiscard]] auto get_row_kernel(Merge_kernel k) -> Row_kernel
+{
+    switch (k) {
+#ifdef TERMOX_X86_KERNELS
+        case Merge_kernel::SSE2: return merge_row_sse2;
+        case Merge_kernel::AVX2: return merge_row_avx2;
+#endif
+        default: return merge_row_scalar;
+    }
+}
+
+/// The kernel in use by merge() and merge_and_diff().
+[[nodiscard]] auto selected_kernel() -> Merge_kernel&
+{
+    static auto kernel = ox::detail::best_merge_kernel();
+    return kernel;
+}
+
+/// Run the selected kernel over each dirty span of \p next.
+void merge_dirty_spans(Canvas const& next,
+                       Canvas& current,
+                       Canvas::Diff* diff_out,
+                       Color_usage* usage)
+{
+    assert(next.area() == current.area());
+    auto const kernel = get_row_kernel(selected_kernel());
+    auto const width  = next.area().width;
+    auto const rows   = next.dirty_rows();
+    for (auto y = rows.begin; y < rows.end; ++y) {
+        auto const span = next.dirty_span(y);
+        if (span.begin >= span.end)
+            continue;
+        auto const offset = (y * width) + span.begin;
+        kernel(&*(std::cbegin(next) + offset), &*(std::begin(current) + offset),
+               span.end - span.begin, {span.begin, y}, diff_out, usage);
+    }
+}
+
+/// Return \p g with its bytes as a single integer.
+[[nodiscard]] auto to_bits(ox::Glyph g) -> std::uint64_t
+{
+    auto bits = std::uint64_t{0};
+    std::memcpy(&bits, &g, sizeof(g));
+    return bits;
+}
+
+/// FNV-1a over whole Glyphs.
+class Row_hash {
+   public:
+    void add(ox::Glyph g)
+    {
+        value_ ^= to_bits(g);
+        value_ *= 1'099'511'628'211u;
+    }
+
+    [[nodiscard]] auto value() const -> std::uint64_t { return value_; }
+
+   private:
+    std::uint64_t value_ = 14'695'981'039'346'656'037u;
+};
+
+/// Return the Glyph at \p i after \p next is merged into \p current.
+[[nodiscard]] auto merged_at(Canvas const& next,
+                             Canvas const& current,
+                             std::ptrdiff_t i) -> ox::Glyph
+{
+    auto const n = *(std::cbegin(next) + i);
+    return n.symbol != U'\0' ? n : *(std::cbegin(current) + i);
+}
+
+/// Return true if row \p y, once \p next is merged, equals current row \p from.
+[[nodiscard]] auto is_row_moved(Canvas const& next,
+                                Canvas const& current,
+                                int y,
+                                int from) -> bool
+{
+    auto const width = current.area().width;
+    for (auto x = 0; x < width; ++x) {
+        auto const merged = merged_at(next, current, (y * width) + x);
+        if (merged != *(std::cbegin(current) + (from * width) + x))
+            return false;
+    }
+    return true;
+}
+
 }  // namespace
 
 namespace ox::detail {
 
-Canvas::Canvas(ox::Area a) : buffer_(a.width * a.height, ox::Glyph{}), area_{a}
+Canvas::Canvas(ox::Area a)
+    : buffer_(a.width * a.height, ox::Glyph{}), area_{a}, dirty_spans_(a.height)
 {}
 
 auto Canvas::area() const -> ox::Area { return area_; }
@@ -49,9 +278,90 @@ auto Canvas::at(ox::Point p) -> ox::Glyph&
 {
     auto const index = p.x + (p.y * area_.width);
     assert(index < (int)buffer_.size());
+    if (write_tracking_) {
+        this->mark_dirty(p);
+        ++write_count_;
+    }
     return buffer_[index];
 }
 
+void Canvas::fill_row(ox::Point p, int width, ox::Glyph g)
+{
+    if (width <= 0)
+        return;
+    assert(p.x >= 0 && p.x + width <= area_.width);
+    assert(p.y >= 0 && p.y < area_.height);
+    auto const row = std::begin(buffer_) + (p.y * area_.width);
+    std::fill_n(row + p.x, width, g);
+    if (!write_tracking_)
+        return;
+    write_count_ += static_cast<std::size_t>(width);
+    auto& span = dirty_spans_[p.y];
+    extend(span, p.x);
+    extend(span, p.x + width - 1);
+    extend(dirty_rows_, p.y);
+}
+
+void Canvas::blit(Canvas const& src, ox::Point p)
+{
+    auto const x_begin = std::max(0, -p.x);
+    auto const x_end   = std::min(src.area_.width, area_.width - p.x);
+    auto const y_begin = std::max(0, -p.y);
+    auto const y_end   = std::min(src.area_.height, area_.height - p.y);
+    for (auto y = y_begin; y < y_end; ++y) {
+        auto const from = std::cbegin(src.buffer_) + (y * src.area_.width);
+        auto const to =
+            std::begin(buffer_) + ((p.y + y) * area_.width) + p.x;
+        auto x = x_begin;
+        while (x < x_end) {
+            // Copy each run of painted Glyphs as a block.
+            while (x < x_end && from[x].symbol == U'\0')
+                ++x;
+            auto const run_begin = x;
+            while (x < x_end && from[x].symbol != U'\0')
+                ++x;
+            if (run_begin == x)
+                continue;
+            std::copy(from + run_begin, from + x, to + run_begin);
+            if (!write_tracking_)
+                continue;
+            auto& span = dirty_spans_[p.y + y];
+            extend(span, p.x + run_begin);
+            extend(span, p.x + x - 1);
+            extend(dirty_rows_, p.y + y);
+            write_count_ += static_cast<std::size_t>(x - run_begin);
+        }
+    }
+}
+
+void Canvas::mark_dirty_area(ox::Point p, ox::Area a)
+{
+    auto const x_begin = std::max(p.x, 0);
+    auto const x_end   = std::min(p.x + a.width, area_.width);
+    auto const y_begin = std::max(p.y, 0);
+    auto const y_end   = std::min(p.y + a.height, area_.height);
+    if (x_begin >= x_end)
+        return;
+    for (auto y = y_begin; y < y_end; ++y) {
+        extend(dirty_spans_[y], x_begin);
+        extend(dirty_spans_[y], x_end - 1);
+        extend(dirty_rows_, y);
+        write_count_ += static_cast<std::size_t>(x_end - x_begin);
+    }
+}
+
+void Canvas::set_write_tracking(bool enable) { write_tracking_ = enable; }
+
+auto Canvas::dirty_span(int y) const -> Span
+{
+    assert(y < (int)dirty_spans_.size());
+    return dirty_spans_[y];
+}
+
+auto Canvas::dirty_rows() const -> Span { return dirty_rows_; }
+
+auto Canvas::write_count() const -> std::size_t { return write_count_; }
+
 void Canvas::resize(ox::Area a)
 {
     if (resize_buffer_ == nullptr)
@@ -59,6 +369,8 @@ void Canvas::resize(ox::Area a)
     resize_buffer_->reset();
     resize_buffer_->area_ = a;
     resize_buffer_->buffer_.resize(a.width * a.height);
+    // at() marks the written cells dirty, swap() does not keep these in step.
+    resize_buffer_->dirty_spans_.resize(a.height);
     auto current = ox::Point{0, 0};
     for (Glyph g : buffer_) {
         if (::is_within(current, a))
@@ -66,6 +378,8 @@ void Canvas::resize(ox::Area a)
         current = next(current, area_);
     }
     this->swap(*resize_buffer_);
+    dirty_spans_.resize(a.height);
+    this->mark_all_dirty();
 }
 
 auto Canvas::begin() -> Buffer_t::iterator { return std::begin(buffer_); }
@@ -85,6 +399,37 @@ auto Canvas::end() const -> Buffer_t::const_iterator
 void Canvas::reset()
 {
     std::fill(std::begin(buffer_), std::end(buffer_), Glyph{});
+    std::fill(std::begin(dirty_spans_), std::end(dirty_spans_), Span{});
+    dirty_rows_  = Span{};
+    write_count_ = 0;
+}
+
+void Canvas::reset_dirty()
+{
+    for (auto y = dirty_rows_.begin; y < dirty_rows_.end; ++y) {
+        auto& span = dirty_spans_[y];
+        if (span.begin >= span.end)
+            continue;
+        auto const row = std::begin(buffer_) + (y * area_.width);
+        std::fill(row + span.begin, row + span.end, Glyph{});
+        span = Span{};
+    }
+    dirty_rows_  = Span{};
+    write_count_ = 0;
+}
+
+void Canvas::mark_dirty(ox::Point p)
+{
+    assert(p.y < (int)dirty_spans_.size());
+    extend(dirty_spans_[p.y], p.x);
+    extend(dirty_rows_, p.y);
+}
+
+void Canvas::mark_all_dirty()
+{
+    std::fill(std::begin(dirty_spans_), std::end(dirty_spans_),
+              Span{0, area_.width});
+    dirty_rows_ = {0, area_.height};
 }
 
 void Canvas::swap(Canvas& x)
@@ -97,31 +442,181 @@ void Canvas::swap(Canvas& x)
     this->area_   = std::move(x_area);
 }
 
-void merge(Canvas const& next, Canvas& current)
+auto is_supported(Merge_kernel k) -> bool
+{
+    switch (k) {
+        case Merge_kernel::Scalar: return true;
+#ifdef TERMOX_X86_KERNELS
+        case Merge_kernel::SSE2: return __builtin_cpu_supports("sse2");
+        case Merge_kernel::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+auto best_merge_kernel() -> Merge_kernel
+{
+    for (auto k : {Merge_kernel::AVX2, Merge_kernel::SSE2}) {
+        if (is_supported(k))
+            return k;
+    }
+    return Merge_kernel::Scalar;
+}
+
+void set_merge_kernel(Merge_kernel k)
+{
+    assert(is_supported(k));
+    selected_kernel() = k;
+}
+
+void merge(Canvas const& next, Canvas& current, Color_usage* usage)
+{
+    merge_dirty_spans(next, current, nullptr, usage);
+}
+
+void merge_and_diff(Canvas const& next,
+                    Canvas& current,
+                    Canvas::Diff& diff_out,
+                    Color_usage* usage)
+{
+    diff_out.clear();
+    merge_dirty_spans(next, current, &diff_out, usage);
+}
+
+auto find_vertical_shift(Canvas const& next,
+                         Canvas const& current,
+                         std::vector<std::uint64_t>& hashes)
+    -> std::optional<Vertical_shift>
 {
     assert(next.area() == current.area());
-    auto next_iter    = std::cbegin(next);
-    auto current_iter = std::begin(current);
-    for (; next_iter != std::cend(next); ++next_iter, ++current_iter) {
-        if (next_iter->symbol != U'\0' && *next_iter != *current_iter)
-            *current_iter = *next_iter;
+    auto constexpr min_rows     = 2;
+    auto constexpr max_distance = 32;
+    auto const width            = current.area().width;
+    auto const rows             = next.dirty_rows();
+
+    // Scrolled content is rewritten in full, so only rows written across most
+    // of the width are considered. Sparse frames return before any hashing.
+    auto const is_wide = [&](int y) {
+        auto const span = next.dirty_span(y);
+        return (span.end - span.begin) * 2 > width;
+    };
+    auto wide_count = 0;
+    auto top        = rows.end;
+    auto bottom     = rows.begin;
+    for (auto y = rows.begin; y < rows.end; ++y) {
+        if (is_wide(y)) {
+            ++wide_count;
+            top    = std::min(top, y);
+            bottom = y + 1;
+        }
+    }
+    if (wide_count < min_rows + 1)
+        return std::nullopt;
+    auto const count = bottom - top;
+
+    // First half is current's rows, second half the rows after merging.
+    hashes.assign(count * 2, 0);
+    for (auto i = 0; i < count; ++i) {
+        if (!is_wide(top + i))
+            continue;
+        auto before = Row_hash{};
+        auto after  = Row_hash{};
+        for (auto x = 0; x < width; ++x) {
+            auto const index = ((top + i) * width) + x;
+            before.add(*(std::cbegin(current) + index));
+            after.add(merged_at(next, current, index));
+        }
+        hashes[i]         = before.value();
+        hashes[count + i] = after.value();
+    }
+    auto const wide   = [&](int i) { return is_wide(top + i); };
+    auto const before = [&](int i) { return hashes[i]; };
+    auto const after  = [&](int i) { return hashes[count + i]; };
+    auto const moved  = [&](int i, int distance) {
+        return wide(i) && wide(i + distance) &&
+               after(i) == before(i + distance);
+    };
+    auto const unchanged = [&](int i) {
+        return !wide(i) || after(i) == before(i);
+    };
+
+    // Each run of rows i where after(i) == before(i + distance) is scored by
+    // the number of rows in it that would otherwise be repainted.
+    auto best        = std::optional<Vertical_shift>{};
+    auto best_score  = min_rows - 1;
+    auto const reach = std::min(count - 1, max_distance);
+    for (auto distance = -reach; distance <= reach; ++distance) {
+        if (distance == 0)
+            continue;
+        auto const first = std::max(0, -distance);
+        auto const last  = std::min(count, count - distance);
+        auto run_begin   = first;
+        auto score       = 0;
+        for (auto i = first; i <= last; ++i) {
+            if (i < last && moved(i, distance)) {
+                if (after(i) != before(i))
+                    ++score;
+                continue;
+            }
+            // Exposed rows are repainted even if they would not have changed.
+            auto const exposed = distance > 0
+                                     ? Canvas::Span{i, i + distance}
+                                     : Canvas::Span{run_begin + distance,
+                                                    run_begin};
+            for (auto j = exposed.begin; j < exposed.end; ++j) {
+                if (unchanged(j))
+                    --score;
+            }
+            if (score > best_score) {
+                best_score = score;
+                best       = distance > 0
+                                 ? Vertical_shift{top + run_begin,
+                                                  top + i + distance, distance}
+                                 : Vertical_shift{top + run_begin + distance,
+                                                  top + i, distance};
+            }
+            run_begin = i + 1;
+            score     = 0;
+        }
+    }
+    if (!best.has_value())
+        return std::nullopt;
+
+    // Rule out hash collisions before the terminal is told to scroll.
+    auto const d     = best->distance;
+    auto const begin = d > 0 ? best->top : best->top - d;
+    auto const end   = d > 0 ? best->bottom - d : best->bottom;
+    for (auto y = begin; y < end; ++y) {
+        if (!is_row_moved(next, current, y, y + d))
+            return std::nullopt;
     }
+    return best;
 }
 
-void merge_and_diff(Canvas const& next, Canvas& current, Canvas::Diff& diff_out)
+void apply_vertical_shift(Vertical_shift s, Canvas& next, Canvas& current)
 {
     assert(next.area() == current.area());
-    diff_out.clear();
-    auto next_iter    = std::cbegin(next);
-    auto current_iter = std::begin(current);
-    auto point        = ox::Point{0, 0};
-    for (; next_iter != std::cend(next); ++next_iter, ++current_iter) {
-        if (next_iter->symbol != U'\0' && *next_iter != *current_iter) {
-            diff_out.push_back({point, *next_iter});
-            *current_iter = *next_iter;
+    auto const width    = current.area().width;
+    auto const distance = std::abs(s.distance);
+    auto const exposed  = s.distance > 0
+                             ? Canvas::Span{s.bottom - distance, s.bottom}
+                             : Canvas::Span{s.top, s.top + distance};
+
+    // Exposed rows are blanked by the scroll, so every cell must be rewritten.
+    for (auto y = exposed.begin; y < exposed.end; ++y) {
+        for (auto x = 0; x < width; ++x) {
+            auto& glyph = next.at({x, y});
+            if (glyph.symbol == U'\0')
+                glyph = *(std::cbegin(current) + (y * width) + x);
         }
-        point = ::next(point, next.area());
     }
+
+    auto const row = [&](int y) { return std::begin(current) + (y * width); };
+    if (s.distance > 0)
+        std::copy(row(s.top + distance), row(s.bottom), row(s.top));
+    else
+        std::copy_backward(row(s.top), row(s.bottom - distance), row(s.bottom));
+    std::fill(row(exposed.begin), row(exposed.end), Glyph{});
 }
 
 void generate_color_diff(Color color,
@@ -137,6 +632,27 @@ void generate_color_diff(Color color,
     }
 }
 
+void generate_color_diff(Color color,
+                         Canvas const& canvas,
+                         Color_usage const& usage,
+                         Canvas::Diff& diff_out)
+{
+    assert(usage.height() == canvas.area().height);
+    diff_out.clear();
+    auto const width = canvas.area().width;
+    for (auto y = 0; y < usage.height(); ++y) {
+        if (!usage.is_used(color, y))
+            continue;
+        auto const row     = std::cbegin(canvas) + (y * width);
+        auto const columns = usage.columns(color, y);
+        for (auto x = columns.begin; x < columns.end; ++x) {
+            auto const g = *(row + x);
+            if (g.brush.foreground == color || g.brush.background == color)
+                diff_out.push_back({{x, y}, g});
+        }
+    }
+}
+
 void generate_full_diff(Canvas const& canvas, Canvas::Diff& diff_out)
 {
     diff_out.clear();
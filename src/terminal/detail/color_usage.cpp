@@ -0,0 +1,37 @@
+#include <termox/terminal/detail/color_usage.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+#include <termox/painter/glyph.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+
+namespace ox::detail {
+
+void Color_usage::rebuild(Canvas const& canvas)
+{
+    height_ = canvas.area().height;
+    counts_.assign(256uL * height_, 0);
+    columns_.assign(256uL * height_, Canvas::Span{});
+    this->recount(canvas, {0, height_});
+}
+
+void Color_usage::recount(Canvas const& canvas, Canvas::Span rows)
+{
+    auto const width = canvas.area().width;
+    for (auto c = 0; c < 256; ++c) {
+        auto const color = Color{static_cast<Color::Value_t>(c)};
+        auto const first = this->index(color, 0);
+        auto const count = std::begin(counts_) + first;
+        auto const span  = std::begin(columns_) + first;
+        std::fill(count + rows.begin, count + rows.end, 0);
+        std::fill(span + rows.begin, span + rows.end, Canvas::Span{});
+    }
+    for (auto y = rows.begin; y < rows.end; ++y) {
+        auto const row = std::cbegin(canvas) + (y * width);
+        for (auto x = 0; x < width; ++x)
+            this->add(*(row + x), {x, y});
+    }
+}
+
+}  // namespace ox::detail
@@ -0,0 +1,276 @@
+#include <termox/terminal/detail/diff_encoder.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cwchar>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <esc/esc.hpp>
+
+#include <termox/common/u32_to_mb.hpp>
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+#include <termox/widget/point.hpp>
+
+namespace {
+
+/// Return true if \p c is known to advance the terminal cursor by one cell.
+/** The cursor position is only tracked across these symbols, anything wider,
+ *  combining or unknown forces an explicit cursor move for the next cell. */
+[[nodiscard]] auto is_single_width(char32_t c) -> bool
+{
+    if (c >= U' ' && c < U'\x7F')
+        return true;
+    return ::wcwidth(static_cast<wchar_t>(c)) == 1;
+}
+
+/// Return true if \p g displays as an empty cell with only a background.
+[[nodiscard]] auto is_blank(ox::Glyph g) -> bool
+{
+    return g.symbol == U' ' && g.brush.traits == ox::Trait::None;
+}
+
+/// Return the number of decimal digits in \p value, which is positive.
+[[nodiscard]] auto digit_count(int value) -> int
+{
+    auto count = 1;
+    while (value >= 10) {
+        value /= 10;
+        ++count;
+    }
+    return count;
+}
+
+/// Return the number of entries from \p iter that repeat its Glyph.
+/** Counts consecutive entries in the same row with adjacent x coordinates. */
+[[nodiscard]] auto run_length(ox::detail::Canvas::Diff::const_iterator iter,
+                              ox::detail::Canvas::Diff::const_iterator end)
+    -> int
+{
+    auto const [point, glyph] = *iter;
+    auto length               = 1;
+    for (++iter; iter != end; ++iter, ++length) {
+        if (iter->first != ox::Point{point.x + length, point.y} ||
+            iter->second != glyph) {
+            break;
+        }
+    }
+    return length;
+}
+
+/// Append the decimal representation of \p value.
+void append_int(int value, std::string& out)
+{
+    auto buffer       = std::array<char, 16>{};
+    auto const result = std::to_chars(buffer.data(),
+                                      buffer.data() + buffer.size(), value);
+    out.append(buffer.data(), result.ptr);
+}
+
+/// Write the SGR true color sequence 'ESC[{38,48};2;r;g;bm' into \p out.
+/** \p selector is 38 for foreground and 48 for background. Returns the number
+ *  of bytes written, \p out must hold at least 19 bytes. */
+auto write_true_color(int selector, ox::True_color tc, char* out)
+    -> std::uint8_t
+{
+    auto* const begin = out;
+    auto* const end   = out + 19;
+    *out++            = '\033';
+    *out++            = '[';
+    for (auto value : {selector, 2, (int)tc.red, (int)tc.green}) {
+        out    = std::to_chars(out, end, value).ptr;
+        *out++ = ';';
+    }
+    out    = std::to_chars(out, end, (int)tc.blue).ptr;
+    *out++ = 'm';
+    return static_cast<std::uint8_t>(out - begin);
+}
+
+/// Append the sequence to move the cursor to \p p, 1-based as 'ESC[y;xH'.
+void append_cursor_position(ox::Point p, std::string& out)
+{
+    out.append("\033[");
+    append_int(p.y + 1, out);
+    out.push_back(';');
+    append_int(p.x + 1, out);
+    out.push_back('H');
+}
+
+/// Append 'ESC[{n}{final}', for the single parameter sequences.
+void append_csi(int n, char final, std::string& out)
+{
+    out.append("\033[");
+    append_int(n, out);
+    out.push_back(final);
+}
+
+/// Append the UTF-8 representation of \p symbol.
+void append_symbol(char32_t symbol, std::string& out)
+{
+    if (symbol < 0x80) {
+        out.push_back(static_cast<char>(symbol));
+        return;
+    }
+    auto bytes       = std::array<char, 4>{};
+    auto const count = ox::u32_to_utf8(symbol, bytes.data());
+    out.append(bytes.data(), count);
+}
+
+}  // namespace
+
+namespace ox::detail {
+
+Diff_encoder::Diff_encoder()
+{
+    auto const default_fg = esc::escape(foreground(esc::Default_color{}));
+    auto const default_bg = esc::escape(background(esc::Default_color{}));
+    for (auto& sequence : fg_table_)
+        sequence.assign(default_fg);
+    for (auto& sequence : bg_table_)
+        sequence.assign(default_bg);
+}
+
+void Diff_encoder::set_color_sequences(Color c,
+                                       std::string_view fg,
+                                       std::string_view bg)
+{
+    fg_table_[c.value].assign(fg);
+    bg_table_[c.value].assign(bg);
+}
+
+void Diff_encoder::set_color_sequences(Color c, True_color tc)
+{
+    auto& fg = fg_table_[c.value];
+    auto& bg = bg_table_[c.value];
+    fg.size  = write_true_color(38, tc, fg.bytes.data());
+    bg.size  = write_true_color(48, tc, bg.bytes.data());
+}
+
+void Diff_encoder::set_repeat(bool enable) { repeat_ = enable; }
+
+void Diff_encoder::set_erase(bool enable) { erase_ = enable; }
+
+void Diff_encoder::encode(Canvas::Diff const& diff, std::string& out)
+{
+    this->reset_state();
+    auto const end = std::cend(diff);
+    for (auto iter = std::cbegin(diff); iter != end;) {
+        auto const [point, glyph] = *iter;
+        auto const length         = run_length(iter, end);
+        auto const after          = std::next(iter, length);
+        this->move_cursor(point, out);
+        this->set_brush(glyph, out);
+
+        // ECH does not move the cursor, so continuing the row needs a CUF.
+        auto const continues =
+            after != end && after->first == Point{point.x + length, point.y};
+        auto const erase_bytes =
+            3 + digit_count(length) + (continues ? 3 + digit_count(length) : 0);
+        if (erase_ && is_blank(glyph) && erase_bytes < length) {
+            append_csi(length, 'X', out);
+            if (continues)
+                append_csi(length, 'C', out);
+            cursor_ = continues ? std::optional{after->first} : std::nullopt;
+            iter    = after;
+            continue;
+        }
+
+        append_symbol(glyph.symbol, out);
+        auto const single_width = is_single_width(glyph.symbol);
+        auto const repeats      = length - 1;
+        auto const symbol_bytes = (int)ox::utf8_length(glyph.symbol);
+        if (repeat_ && single_width &&
+            3 + digit_count(repeats) < repeats * symbol_bytes) {
+            append_csi(repeats, 'b', out);
+        }
+        else {
+            for (auto x = point.x + 1; x < point.x + length; ++x) {
+                if (!single_width)
+                    append_cursor_position({x, point.y}, out);
+                append_symbol(glyph.symbol, out);
+            }
+        }
+        cursor_ = single_width ? std::optional{Point{point.x + length, point.y}}
+                               : std::nullopt;
+        iter    = after;
+    }
+}
+
+void Diff_encoder::encode_scroll(Vertical_shift s, std::string& out)
+{
+    out.append("\033[0m\033[");
+    append_int(s.top + 1, out);
+    out.push_back(';');
+    append_int(s.bottom, out);
+    out.append("r\033[");
+    append_int(std::abs(s.distance), out);
+    out.push_back(s.distance > 0 ? 'S' : 'T');
+    out.append("\033[r");
+
+    // DECSTBM moves the cursor home.
+    this->reset_state();
+}
+
+void Diff_encoder::reset_state()
+{
+    cursor_     = std::nullopt;
+    traits_     = std::nullopt;
+    foreground_ = std::nullopt;
+    background_ = std::nullopt;
+}
+
+void Diff_encoder::move_cursor(Point p, std::string& out)
+{
+    if (cursor_ == p)
+        return;
+    append_cursor_position(p, out);
+    cursor_ = p;
+}
+
+void Diff_encoder::set_brush(Glyph g, std::string& out)
+{
+    if (traits_ != g.brush.traits) {
+        out.append(this->traits_sequence(g.brush.traits));
+        traits_ = g.brush.traits;
+        // Trait sequences are allowed to reset colors, so resend them.
+        foreground_ = std::nullopt;
+        background_ = std::nullopt;
+    }
+    if (foreground_ != g.brush.foreground) {
+        out.append(fg_table_[g.brush.foreground.value].view());
+        foreground_ = g.brush.foreground;
+    }
+    if (background_ != g.brush.background) {
+        out.append(bg_table_[g.brush.background.value].view());
+        background_ = g.brush.background;
+    }
+}
+
+auto Diff_encoder::traits_sequence(Traits t) -> std::string const&
+{
+    auto const iter =
+        std::find_if(std::cbegin(traits_store_), std::cend(traits_store_),
+                     [t](auto const& pair) { return pair.first == t; });
+    if (iter != std::cend(traits_store_))
+        return iter->second;
+    return traits_store_.emplace_back(t, esc::escape(t)).second;
+}
+
+void Diff_encoder::Color_sequence::assign(std::string_view sequence)
+{
+    assert(sequence.size() <= capacity);
+    size = static_cast<std::uint8_t>(std::min<std::size_t>(sequence.size(),
+                                                           capacity));
+    std::copy_n(sequence.data(), size, bytes.data());
+}
+
+}  // namespace ox::detail
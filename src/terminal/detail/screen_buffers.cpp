@@ -1,31 +1,49 @@
 #include <termox/terminal/detail/screen_buffers.hpp>
 
+#include <optional>
+
 #include <termox/terminal/detail/canvas.hpp>
+#include <termox/terminal/detail/color_usage.hpp>
 #include <termox/widget/area.hpp>
 
 namespace ox::detail {
 
-Screen_buffers::Screen_buffers(ox::Area a) : current{a}, next{a} {}
+Screen_buffers::Screen_buffers(ox::Area a) : current{a}, next{a}
+{
+    usage_.rebuild(current);
+}
 
 void Screen_buffers::resize(ox::Area a)
 {
     current.resize(a);
     next.resize(a);
+    usage_.rebuild(current);
 }
 
 auto Screen_buffers::area() const -> Area { return current.area(); }
 
-void Screen_buffers::merge() { ::ox::detail::merge(next, current); }
+void Screen_buffers::merge() { ::ox::detail::merge(next, current, &usage_); }
 
 auto Screen_buffers::merge_and_diff() -> Canvas::Diff const&
 {
-    ::ox::detail::merge_and_diff(next, current, diff_);
+    ::ox::detail::merge_and_diff(next, current, diff_, &usage_);
     return diff_;
 }
 
+auto Screen_buffers::find_vertical_shift() -> std::optional<Vertical_shift>
+{
+    return ::ox::detail::find_vertical_shift(next, current, row_hashes_);
+}
+
+void Screen_buffers::apply_vertical_shift(Vertical_shift s)
+{
+    ::ox::detail::apply_vertical_shift(s, next, current);
+    usage_.recount(current, {s.top, s.bottom});
+}
+
 auto Screen_buffers::generate_color_diff(Color c) -> Canvas::Diff const&
 {
-    ::ox::detail::generate_color_diff(c, current, diff_);
+    ::ox::detail::generate_color_diff(c, current, usage_, diff_);
     return diff_;
 }
 
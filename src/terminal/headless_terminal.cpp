@@ -0,0 +1,469 @@
+#include <termox/terminal/headless_terminal.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <esc/event.hpp>
+
+#include <termox/widget/area.hpp>
+#include <termox/widget/point.hpp>
+
+namespace {
+
+auto constexpr escape = '\033';
+
+/// Return the number of bytes in the UTF-8 sequence starting with \p lead.
+/** Returns zero if \p lead cannot start a sequence. */
+[[nodiscard]] auto utf8_length(unsigned char lead) -> std::size_t
+{
+    if (lead < 0x80)
+        return 1;
+    if ((lead & 0xE0) == 0xC0)
+        return 2;
+    if ((lead & 0xF0) == 0xE0)
+        return 3;
+    if ((lead & 0xF8) == 0xF0)
+        return 4;
+    return 0;
+}
+
+/// Decode the \p length byte UTF-8 sequence at the front of \p bytes.
+[[nodiscard]] auto utf8_decode(std::string_view bytes, std::size_t length)
+    -> char32_t
+{
+    static constexpr unsigned char lead_mask[] = {0, 0x7F, 0x1F, 0x0F, 0x07};
+    auto result = static_cast<char32_t>(
+        static_cast<unsigned char>(bytes[0]) & lead_mask[length]);
+    for (auto i = 1uL; i < length; ++i) {
+        result = (result << 6) |
+                 (static_cast<unsigned char>(bytes[i]) & 0x3Fu);
+    }
+    return result;
+}
+
+/// Split CSI parameters 'n;n;n' into integers, an empty parameter is zero.
+[[nodiscard]] auto parse_params(std::string_view text) -> std::vector<int>
+{
+    auto result = std::vector<int>{};
+    if (text.empty())
+        return result;
+    result.push_back(0);
+    for (char c : text) {
+        if (c == ';' || c == ':')
+            result.push_back(0);
+        else if (c >= '0' && c <= '9')
+            result.back() = (result.back() * 10) + (c - '0');
+    }
+    return result;
+}
+
+/// Return parameter \p i, or \p fallback if it is missing or zero.
+[[nodiscard]] auto param_or(std::vector<int> const& params,
+                            std::size_t i,
+                            int fallback) -> int
+{
+    return (i < params.size() && params[i] != 0) ? params[i] : fallback;
+}
+
+/// Parse one to four hex digits of an OSC color spec, scaled to 8 bits.
+[[nodiscard]] auto parse_color_component(std::string_view hex)
+    -> std::optional<std::uint32_t>
+{
+    if (hex.empty() || hex.size() > 4)
+        return std::nullopt;
+    auto value = std::uint32_t{0};
+    for (char c : hex) {
+        auto const lower = c | 0x20;
+        if (c >= '0' && c <= '9')
+            value = (value << 4) | static_cast<std::uint32_t>(c - '0');
+        else if (lower >= 'a' && lower <= 'f')
+            value = (value << 4) | static_cast<std::uint32_t>(lower - 'a' + 10);
+        else
+            return std::nullopt;
+    }
+    auto const max = (std::uint32_t{1} << (hex.size() * 4)) - 1;
+    return value * 255 / max;
+}
+
+}  // namespace
+
+namespace ox {
+
+Headless_terminal::Headless_terminal(Area a)
+    : area_{a}, cells_(a.width * a.height), scroll_bottom_{a.height}
+{}
+
+auto Headless_terminal::area() const -> Area { return area_; }
+
+void Headless_terminal::write(std::string_view bytes)
+{
+    auto const lock = this->Lockable::lock();
+    stats_.bytes += bytes.size();
+    ++stats_.writes;
+    partial_.append(bytes);
+    auto const text = std::string_view{partial_};
+    auto position   = std::size_t{0};
+    while (position < text.size()) {
+        auto const used = this->apply(text.substr(position));
+        if (used == 0)
+            break;
+        position += used;
+    }
+    partial_.erase(0, position);
+}
+
+auto Headless_terminal::read() -> esc::Event
+{
+    auto lock = std::unique_lock{this->Lockable::mutex()};
+    input_ready_.wait(lock, [this] { return !input_.empty(); });
+    auto e = std::move(input_.front());
+    input_.pop_front();
+    return e;
+}
+
+auto Headless_terminal::has_input() const -> bool
+{
+    auto const lock = this->Lockable::lock();
+    return !input_.empty();
+}
+
+void Headless_terminal::push_input(esc::Event e)
+{
+    auto const lock = this->Lockable::lock();
+    input_.push_back(std::move(e));
+    input_ready_.notify_one();
+}
+
+auto Headless_terminal::at(Point p) const -> Cell
+{
+    auto const lock = this->Lockable::lock();
+    return cells_[(p.y * area_.width) + p.x];
+}
+
+auto Headless_terminal::row(int y) const -> std::u32string
+{
+    auto const lock  = this->Lockable::lock();
+    auto result      = std::u32string{};
+    auto const begin = std::cbegin(cells_) + (y * area_.width);
+    std::transform(begin, begin + area_.width, std::back_inserter(result),
+                   [](Cell const& c) { return c.symbol; });
+    return result;
+}
+
+auto Headless_terminal::palette_entry(int index) const
+    -> std::optional<std::uint32_t>
+{
+    auto const lock = this->Lockable::lock();
+    auto const iter = palette_.find(index);
+    if (iter == std::cend(palette_))
+        return std::nullopt;
+    return iter->second;
+}
+
+auto Headless_terminal::cursor() const -> Point
+{
+    auto const lock = this->Lockable::lock();
+    return cursor_;
+}
+
+auto Headless_terminal::stats() const -> Stats
+{
+    auto const lock = this->Lockable::lock();
+    return stats_;
+}
+
+void Headless_terminal::reset_stats()
+{
+    auto const lock = this->Lockable::lock();
+    stats_          = Stats{};
+}
+
+auto Headless_terminal::apply(std::string_view bytes) -> std::size_t
+{
+    auto const lead = static_cast<unsigned char>(bytes[0]);
+    if (lead == escape) {
+        if (bytes.size() < 2)
+            return 0;
+        if (bytes[1] == '[') {
+            // Final byte of a CSI sequence is in range [0x40, 0x7E].
+            auto const final = std::find_if(
+                std::next(std::cbegin(bytes), 2), std::cend(bytes),
+                [](char c) { return c >= 0x40 && c <= 0x7E; });
+            if (final == std::cend(bytes))
+                return 0;
+            auto const end = std::distance(std::cbegin(bytes), final) + 1;
+            this->apply_csi(bytes.substr(2, end - 2));
+            return end;
+        }
+        if (bytes[1] == ']') {
+            // OSC is terminated by BEL or ST.
+            for (auto i = 2uL; i < bytes.size(); ++i) {
+                if (bytes[i] == '\a') {
+                    this->apply_osc(bytes.substr(2, i - 2));
+                    return i + 1;
+                }
+                if (bytes[i] == escape && i + 1 < bytes.size()) {
+                    this->apply_osc(bytes.substr(2, i - 2));
+                    return i + 2;
+                }
+            }
+            return 0;
+        }
+        return 2;
+    }
+    if (lead < 0x20 || lead == 0x7F) {
+        switch (lead) {
+            case '\r': cursor_.x = 0; break;
+            case '\b': cursor_.x = std::max(0, cursor_.x - 1); break;
+            case '\n':
+                if (cursor_.y == scroll_bottom_ - 1)
+                    this->scroll(1);
+                else
+                    cursor_.y = std::min(cursor_.y + 1, area_.height - 1);
+                break;
+        }
+        return 1;
+    }
+    auto const length = utf8_length(lead);
+    if (length == 0) {
+        this->put(U'�');
+        return 1;
+    }
+    if (bytes.size() < length)
+        return 0;
+    this->put(utf8_decode(bytes, length));
+    return length;
+}
+
+void Headless_terminal::apply_osc(std::string_view body)
+{
+    auto const separator = body.find(';');
+    auto const command   = body.substr(0, separator);
+    auto const rest      = separator == std::string_view::npos
+                               ? std::string_view{}
+                               : body.substr(separator + 1);
+    if (command == "104") {
+        // Reset the listed entries, or every entry if none are listed.
+        if (rest.empty())
+            palette_.clear();
+        for (int index : parse_params(rest))
+            palette_.erase(index);
+        return;
+    }
+    if (command != "4")
+        return;
+    // A single 'index;rgb:rr/gg/bb', queries with '?' are not modeled.
+    auto const color_at = rest.find(";rgb:");
+    if (color_at == std::string_view::npos)
+        return;
+    auto const index = parse_params(rest.substr(0, color_at));
+    if (index.size() != 1 || index[0] > 255)
+        return;
+    auto spec  = rest.substr(color_at + 5);
+    auto value = std::uint32_t{0};
+    for (auto i = 0; i < 3; ++i) {
+        auto const end       = spec.find('/');
+        auto const component = parse_color_component(spec.substr(0, end));
+        if (!component.has_value())
+            return;
+        value = (value << 8) | *component;
+        spec  = end == std::string_view::npos ? std::string_view{}
+                                              : spec.substr(end + 1);
+    }
+    palette_[index[0]] = value;
+}
+
+void Headless_terminal::apply_csi(std::string_view body)
+{
+    auto const final = body.back();
+    auto const text  = body.substr(0, body.size() - 1);
+
+    // Private and intermediate bytes mark modes and queries, none are modeled.
+    auto const is_plain =
+        std::all_of(std::cbegin(text), std::cend(text), [](char c) {
+            return (c >= '0' && c <= '9') || c == ';' || c == ':';
+        });
+    if (!is_plain)
+        return;
+
+    auto const params = parse_params(text);
+    auto const n      = param_or(params, 0, 1);
+    auto const clamp  = [this](Point p) {
+        return Point{std::clamp(p.x, 0, area_.width - 1),
+                     std::clamp(p.y, 0, area_.height - 1)};
+    };
+    switch (final) {
+        case 'H':
+        case 'f':
+            cursor_ = clamp({param_or(params, 1, 1) - 1, n - 1});
+            break;
+        case 'A': cursor_ = clamp({cursor_.x, cursor_.y - n}); break;
+        case 'B': cursor_ = clamp({cursor_.x, cursor_.y + n}); break;
+        case 'C': cursor_ = clamp({cursor_.x + n, cursor_.y}); break;
+        case 'D': cursor_ = clamp({cursor_.x - n, cursor_.y}); break;
+        case 'G': cursor_ = clamp({n - 1, cursor_.y}); break;
+        case 'd': cursor_ = clamp({cursor_.x, n - 1}); break;
+        case 'm': this->apply_sgr(params.empty() ? std::vector{0} : params);
+            break;
+        case 'r': {
+            auto const top    = param_or(params, 0, 1) - 1;
+            auto const bottom = param_or(params, 1, area_.height);
+            if (top < bottom && bottom <= area_.height) {
+                scroll_top_    = top;
+                scroll_bottom_ = bottom;
+                cursor_        = {0, 0};
+            }
+            break;
+        }
+        case 'S': this->scroll(n); break;
+        case 'T': this->scroll(-n); break;
+        case 'J': {
+            auto const mode = params.empty() ? 0 : params[0];
+            auto const y    = cursor_.y;
+            if (mode == 0) {
+                this->erase(y, cursor_.x, area_.width);
+                for (auto i = y + 1; i < area_.height; ++i)
+                    this->erase(i, 0, area_.width);
+            }
+            else if (mode == 1) {
+                for (auto i = 0; i < y; ++i)
+                    this->erase(i, 0, area_.width);
+                this->erase(y, 0, cursor_.x + 1);
+            }
+            else {
+                for (auto i = 0; i < area_.height; ++i)
+                    this->erase(i, 0, area_.width);
+            }
+            break;
+        }
+        case 'K': {
+            auto const mode = params.empty() ? 0 : params[0];
+            if (mode == 0)
+                this->erase(cursor_.y, cursor_.x, area_.width);
+            else if (mode == 1)
+                this->erase(cursor_.y, 0, cursor_.x + 1);
+            else
+                this->erase(cursor_.y, 0, area_.width);
+            break;
+        }
+        case 'X': this->erase(cursor_.y, cursor_.x, cursor_.x + n); break;
+        case 'b':
+            for (auto i = 0; i < n; ++i)
+                this->put(pen_.symbol);
+            break;
+    }
+}
+
+void Headless_terminal::apply_sgr(std::vector<int> const& params)
+{
+    auto const extended_color = [&](std::size_t& i) {
+        auto result = Cell_color{};
+        if (i + 2 < params.size() && params[i + 1] == 5) {
+            result = {Cell_color::Kind::Index,
+                      static_cast<std::uint32_t>(params[i + 2])};
+            i += 2;
+        }
+        else if (i + 4 < params.size() && params[i + 1] == 2) {
+            auto const rgb = (static_cast<std::uint32_t>(params[i + 2]) << 16) |
+                             (static_cast<std::uint32_t>(params[i + 3]) << 8) |
+                             static_cast<std::uint32_t>(params[i + 4]);
+            result = {Cell_color::Kind::RGB, rgb};
+            i += 4;
+        }
+        return result;
+    };
+    auto const index = [](int i) {
+        return Cell_color{Cell_color::Kind::Index,
+                          static_cast<std::uint32_t>(i)};
+    };
+    auto const clear = [this](int sgr) {
+        pen_.attributes &= static_cast<std::uint16_t>(~(1u << sgr));
+    };
+
+    for (auto i = 0uL; i < params.size(); ++i) {
+        auto const p = params[i];
+        if (p == 0) {
+            pen_.foreground = Cell_color{};
+            pen_.background = Cell_color{};
+            pen_.attributes = 0;
+        }
+        else if (p >= 1 && p <= 9)
+            pen_.attributes |= static_cast<std::uint16_t>(1u << p);
+        else if (p == 22) {
+            clear(1);
+            clear(2);
+        }
+        else if (p >= 23 && p <= 29)
+            clear(p - 20);
+        else if (p >= 30 && p <= 37)
+            pen_.foreground = index(p - 30);
+        else if (p >= 90 && p <= 97)
+            pen_.foreground = index(p - 90 + 8);
+        else if (p >= 40 && p <= 47)
+            pen_.background = index(p - 40);
+        else if (p >= 100 && p <= 107)
+            pen_.background = index(p - 100 + 8);
+        else if (p == 38)
+            pen_.foreground = extended_color(i);
+        else if (p == 48)
+            pen_.background = extended_color(i);
+        else if (p == 39)
+            pen_.foreground = Cell_color{};
+        else if (p == 49)
+            pen_.background = Cell_color{};
+    }
+}
+
+void Headless_terminal::put(char32_t symbol)
+{
+    pen_.symbol = symbol;
+    if (cursor_.x >= area_.width)
+        return;
+    this->cell(cursor_) = pen_;
+    ++cursor_.x;
+}
+
+void Headless_terminal::scroll(int n)
+{
+    auto const height = scroll_bottom_ - scroll_top_;
+    n                 = std::clamp(n, -height, height);
+    auto const row = [this](int y) {
+        return std::begin(cells_) + (y * area_.width);
+    };
+    if (n > 0) {
+        std::copy(row(scroll_top_ + n), row(scroll_bottom_), row(scroll_top_));
+        for (auto y = scroll_bottom_ - n; y < scroll_bottom_; ++y)
+            this->erase(y, 0, area_.width);
+    }
+    else if (n < 0) {
+        std::copy_backward(row(scroll_top_), row(scroll_bottom_ + n),
+                           row(scroll_bottom_));
+        for (auto y = scroll_top_; y < scroll_top_ - n; ++y)
+            this->erase(y, 0, area_.width);
+    }
+}
+
+void Headless_terminal::erase(int y, int begin, int end)
+{
+    auto blank       = Cell{};
+    blank.background = pen_.background;
+    begin            = std::clamp(begin, 0, area_.width);
+    end              = std::clamp(end, begin, area_.width);
+    auto const row   = std::begin(cells_) + (y * area_.width);
+    std::fill(row + begin, row + end, blank);
+}
+
+auto Headless_terminal::cell(Point p) -> Cell&
+{
+    return cells_[(p.y * area_.width) + p.x];
+}
+
+}  // namespace ox
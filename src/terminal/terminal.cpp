@@ -1,18 +1,29 @@
 #include <termox/terminal/terminal.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <csignal>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <iterator>
 #include <map>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 
+#include <poll.h>
+#include <unistd.h>
+
 #include <esc/esc.hpp>
 
-#include <termox/common/u32_to_mb.hpp>
+#include <termox/common/seqlock.hpp>
 #include <termox/painter/color.hpp>
 #include <termox/painter/detail/is_paintable.hpp>
 #include <termox/painter/palette/dawn_bringer16.hpp>
@@ -20,6 +31,9 @@
 #include <termox/system/event.hpp>
 #include <termox/system/system.hpp>
 #include <termox/terminal/detail/canvas.hpp>
+#include <termox/terminal/detail/diff_encoder.hpp>
+#include <termox/terminal/render_stats.hpp>
+#include <termox/terminal/terminal_sink.hpp>
 #include <termox/widget/widget.hpp>
 
 extern "C" void uninit_and_exit(int /* sig*/)
@@ -30,49 +44,232 @@ extern "C" void uninit_and_exit(int /* sig*/)
 
 namespace {
 
-using Color_store = std::map<ox::Color, std::string>;
+auto encoder = ox::detail::Diff_encoder{};
+
+using Clock_t = std::chrono::steady_clock;
+
+/// Statistics of the last refresh(), written only by the rendering thread.
+auto frame_stats = ox::Seqlock<ox::Render_stats>{};
+
+/// Receives all output and provides input instead of stdin/stdout, if set.
+ox::Terminal_sink* sink = nullptr;
 
-auto fg_store = Color_store{};
+/// Escape sequences for the frame being written.
+/** Cleared after each write but never shrunk, after the first few frames its
+ *  capacity covers a full screen and encoding a frame does not allocate. */
+auto frame_buffer = std::string{};
 
-auto bg_store = Color_store{};
+// Begin and End Synchronized Update, DEC private mode 2026.
+auto constexpr begin_synchronized_update = std::string_view{"\033[?2026h"};
+auto constexpr end_synchronized_update   = std::string_view{"\033[?2026l"};
 
-/// Return the terminal escape sequence for the given Color \p c as foreground.
-/** Returns the terminal default foreground color sequence if \p c is not in the
- *  currently set palette. */
-[[nodiscard]] auto get_fg_sequence(ox::Color c) -> std::string
+/// Write all of \p bytes to stdout, retrying on partial writes and EINTR.
+/** Writes to the Terminal_sink instead, if one is set. */
+void write_all(std::string_view bytes)
 {
-    if (auto const iter = fg_store.find(c); iter != std::cend(fg_store))
-        return iter->second;
-    else
-        return esc::escape(foreground(esc::Default_color{}));
+    if (bytes.empty())
+        return;
+    if (sink != nullptr) {
+        sink->write(bytes);
+        return;
+    }
+    auto const* data = bytes.data();
+    auto remaining   = bytes.size();
+    while (remaining != 0) {
+        auto const written = ::write(STDOUT_FILENO, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        data += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
 }
 
-/// Return the terminal escape sequence for the given Color \p c as background.
-/** Returns the terminal default background color sequence if \p c is not in the
- *  currently set palette. */
-[[nodiscard]] auto get_bg_sequence(ox::Color c) -> std::string
+/// Encode \p diff and write it to the terminal with a single write() call.
+/** Anything buffered by esc is flushed first so output stays in order. Only a
+ *  partial write or EINTR will cause a second write() for the same frame. If
+ *  \p synchronized, the frame is wrapped in BSU/ESU within the same write.
+ *  \p shift is written before \p diff, if there is one. The emitted cells,
+ *  bytes and encode and write times are recorded in \p stats if not null. */
+void write_frame(ox::detail::Canvas::Diff const& diff,
+                 bool synchronized,
+                 std::optional<ox::detail::Vertical_shift> shift = std::nullopt,
+                 ox::Render_stats* stats = nullptr)
 {
-    if (auto const iter = bg_store.find(c); iter != std::cend(bg_store))
-        return iter->second;
-    else
-        return esc::escape(background(esc::Default_color{}));
+    ::esc::flush();
+    if (diff.empty() && !shift.has_value())
+        return;
+    auto const start = Clock_t::now();
+    if (synchronized)
+        frame_buffer.append(begin_synchronized_update);
+    if (shift.has_value())
+        encoder.encode_scroll(*shift, frame_buffer);
+    encoder.encode(diff, frame_buffer);
+    if (synchronized)
+        frame_buffer.append(end_synchronized_update);
+    auto const encoded = Clock_t::now();
+    write_all(frame_buffer);
+    if (stats != nullptr) {
+        stats->cells_emitted = diff.size();
+        stats->bytes_written = frame_buffer.size();
+        stats->encode_time   = encoded - start;
+        stats->write_time    = Clock_t::now() - encoded;
+    }
+    frame_buffer.clear();
+}
+
+/// Return the number of cells within the dirty spans of \p c.
+[[nodiscard]] auto count_dirty_cells(ox::detail::Canvas const& c)
+    -> std::size_t
+{
+    auto count      = std::size_t{0};
+    auto const rows = c.dirty_rows();
+    for (auto y = rows.begin; y < rows.end; ++y) {
+        auto const span = c.dirty_span(y);
+        count += static_cast<std::size_t>(span.end - span.begin);
+    }
+    return count;
+}
+
+/// Return true if \p reply contains a DA1 reply, 'ESC[?Ps;...;Psc'.
+[[nodiscard]] auto has_device_attributes_reply(std::string_view reply) -> bool
+{
+    auto constexpr prefix = std::string_view{"\033[?"};
+    for (auto at = reply.find(prefix); at != std::string_view::npos;
+         at      = reply.find(prefix, at + 1)) {
+        auto const end = reply.find_first_not_of("0123456789;",
+                                                 at + prefix.size());
+        if (end != std::string_view::npos && reply[end] == 'c')
+            return true;
+    }
+    return false;
+}
+
+/// Send \p queries to the terminal and return everything it replies with.
+/** Primary Device Attributes is sent last, every terminal answers it and in
+ *  order, so unsupported queries are detected as soon as its reply arrives
+ *  rather than by timeout. Must be called after the terminal is in raw mode
+ *  and before any input is read. Any user input read while waiting for the
+ *  replies is discarded. */
+[[nodiscard]] auto query_terminal(std::string_view queries) -> std::string
+{
+    auto constexpr timeout_ms = 250;
+    write_all(queries);
+    write_all("\033[c");
+
+    auto reply = std::string{};
+    while (reply.size() < 1'024) {
+        auto fds = ::pollfd{STDIN_FILENO, POLLIN, 0};
+        if (::poll(&fds, 1, timeout_ms) <= 0)
+            break;
+        auto buffer      = std::array<char, 64>{};
+        auto const count = ::read(STDIN_FILENO, buffer.data(), buffer.size());
+        if (count <= 0)
+            break;
+        reply.append(buffer.data(), static_cast<std::size_t>(count));
+        if (has_device_attributes_reply(reply))
+            break;
+    }
+    return reply;
+}
+
+// DECRQM for mode 2026, reply is 'ESC[?2026;Ps$y', Ps of 1 or 2 means set or
+// reset, so the mode is known.
+auto constexpr synchronized_output_query = std::string_view{"\033[?2026$p"};
+
+[[nodiscard]] auto has_synchronized_output_reply(std::string_view reply)
+    -> bool
+{
+    return reply.find("\033[?2026;1$y") != std::string_view::npos ||
+           reply.find("\033[?2026;2$y") != std::string_view::npos;
+}
+
+// REP probe, writes one cell at home and repeats it, then asks for the cursor
+// position with DSR. The reply is 'ESC[1;3R' if REP moved the cursor.
+auto constexpr repeat_query = std::string_view{"\033[H \033[1b\033[6n"};
+
+[[nodiscard]] auto has_repeat_reply(std::string_view reply) -> bool
+{
+    return reply.find("\033[1;3R") != std::string_view::npos;
+}
+
+// XTGETTCAP query of the terminfo 'bce' flag, hex encoded. The reply is
+// 'DCS 1+r 626365 ST' if the flag is set, other terminals ignore the query.
+auto constexpr bce_query = std::string_view{"\033P+q626365\033\\"};
+
+[[nodiscard]] auto has_bce_reply(std::string_view reply) -> bool
+{
+    return reply.find("\033P1+r626365") != std::string_view::npos;
+}
+
+// OSC 4 query of palette entry 0, reply is 'OSC 4;0;rgb:rrrr/gggg/bbbb ST'.
+auto constexpr palette_query = std::string_view{"\033]4;0;?\033\\"};
+
+[[nodiscard]] auto has_palette_reply(std::string_view reply) -> bool
+{
+    return reply.find("\033]4;0;rgb:") != std::string_view::npos;
+}
+
+/// Terminal palette entries reserved for Dynamic_colors, by Color.
+auto palette_slots = std::map<ox::Color, std::uint8_t>{};
+
+/// Redefine terminal palette entry \p slot as \p tc, with OSC 4.
+void redefine_palette_slot(std::uint8_t slot, ox::True_color tc)
+{
+    auto constexpr hex = std::string_view{"0123456789abcdef"};
+    auto buffer        = std::array<char, 32>{};
+    auto* const end    = buffer.data() + buffer.size();
+    auto* iter         = std::copy_n("\033]4;", 4, buffer.data());
+    iter               = std::to_chars(iter, end, (int)slot).ptr;
+    iter               = std::copy_n(";rgb:", 5, iter);
+    for (auto value : {tc.red, tc.green, tc.blue}) {
+        *iter++ = hex[value >> 4u];
+        *iter++ = hex[value & 0xFu];
+        *iter++ = '/';
+    }
+    // Replace the last '/' with ST.
+    iter    = std::copy_n("\033\\", 2, iter - 1);
+    ::esc::flush();
+    write_all({buffer.data(), static_cast<std::size_t>(iter - buffer.data())});
 }
 
-/// Convert a Canvas::Diff into a terminal escape sequence.
-[[nodiscard]] auto to_escape_sequence(ox::detail::Canvas::Diff const& diff)
-    -> std::string
+/// Reset every reserved palette entry to the terminal default, with OSC 104.
+void release_palette_slots()
 {
     auto sequence = std::string{};
-    for (auto [point, glyph] : diff) {
-        using esc::escape;
-        sequence.append(escape(esc::Cursor_position{point}));
-        if (::esc::traits() != glyph.brush.traits)
-            sequence.append(escape(glyph.brush.traits));
-        sequence.append(get_fg_sequence(glyph.brush.foreground));
-        sequence.append(get_bg_sequence(glyph.brush.background));
-        sequence.append(ox::u32_to_mb(glyph.symbol));
+    for (auto [color, slot] : palette_slots) {
+        sequence.append("\033]104;");
+        sequence.append(std::to_string(slot));
+        sequence.append("\033\\");
     }
-    return sequence;
+    palette_slots.clear();
+    ::esc::flush();
+    write_all(sequence);
+}
+
+/// Return the highest terminal palette entry not used by \p palette.
+/** Entries already in palette_slots are also skipped. Returns std::nullopt if
+ *  every entry is taken. */
+[[nodiscard]] auto find_free_palette_slot(ox::Palette const& palette)
+    -> std::optional<std::uint8_t>
+{
+    for (auto slot = 255; slot >= 0; --slot) {
+        auto const is_used = [slot](auto const& def) {
+            auto const* index = std::get_if<ox::Color_index>(&def.value);
+            return index != nullptr && index->value == slot;
+        };
+        auto const is_reserved = [slot](auto const& pair) {
+            return pair.second == slot;
+        };
+        if (std::none_of(std::cbegin(palette), std::cend(palette), is_used) &&
+            std::none_of(std::cbegin(palette_slots), std::cend(palette_slots),
+                         is_reserved)) {
+            return static_cast<std::uint8_t>(slot);
+        }
+    }
+    return std::nullopt;
 }
 
 /// Used as the return type for color_sequences() functions.
@@ -132,7 +329,7 @@ template <typename T>
 [[nodiscard]] auto transform(::esc::Scroll_wheel x) -> ox::Event
 {
     auto [receiver, mouse] = mouse_event_info(x);
-    return ox::Mouse_wheel_event{receiver, mouse};
+    return ox::Mouse_wheel_event{receiver, mouse, 1};
 }
 
 /// Tranform Mouse_move events to ox::Events.
@@ -169,6 +366,39 @@ template <typename T>
 /// Tranform Window_resize events to ox::Events.
 [[nodiscard]] auto transform(::esc::Window_resize x) -> ox::Event { return x; }
 
+/// Tranform events read before the Events ahead of them have been sent.
+template <typename T>
+[[nodiscard]] auto transform_ahead(T x) -> ox::Event
+{
+    return transform(std::move(x));
+}
+
+/// Key_press receiver is the focus Widget when sent, not when read.
+[[nodiscard]] auto transform_ahead(::esc::Key_press x) -> ox::Event
+{
+    return ox::Custom_event{[x] { ox::System::send_event(transform(x)); }};
+}
+
+/// Key_release receiver is the focus Widget when sent, not when read.
+[[nodiscard]] auto transform_ahead(::esc::Key_release x) -> ox::Event
+{
+    return ox::Custom_event{[x] { ox::System::send_event(transform(x)); }};
+}
+
+/// An Event read ahead by wait_for_input(), returned by the next read.
+/** Only touched by the thread that reads input. */
+auto read_ahead = std::optional<::esc::Event>{};
+
+/// Return the next Event if one can be read from stdin without blocking.
+/** The esc parser can hold bytes of a later Event after a read, poll() on
+ *  stdin does not see those, so the parser is asked instead of stdin. */
+[[nodiscard]] auto try_read_stdin() -> std::optional<::esc::Event>
+{
+    if (read_ahead.has_value())
+        return std::exchange(read_ahead, std::nullopt);
+    return ::esc::read(0);
+}
+
 /// Return true if \p point is within \p area.
 [[nodiscard, maybe_unused]] auto is_within(ox::Point point, ox::Area area)
     -> bool
@@ -187,6 +417,22 @@ void Terminal::initialize(Mouse_mode mouse_mode,
     if (is_initialized_)
         return;
     ::esc::initialize_interactive_terminal(mouse_mode, key_mode, signals);
+    ::esc::flush();
+    {
+        auto const reply = query_terminal(std::string{
+                                              synchronized_output_query} +
+                                          std::string{palette_query} +
+                                          std::string{bce_query} +
+                                          std::string{repeat_query});
+        has_synchronized_output_  = has_synchronized_output_reply(reply);
+        has_palette_redefinition_ = has_palette_reply(reply);
+        has_repeat_               = has_repeat_reply(reply);
+        has_bce_                  = has_bce_reply(reply);
+        // Erase the REP probe, the first frame is a full repaint.
+        write_all("\033[H\033[2K");
+    }
+    encoder.set_repeat(has_repeat_);
+    encoder.set_erase(has_bce_);
     if (handle_sigint_)
         std::signal(SIGINT, &uninit_and_exit);
     Terminal::set_palette(dawn_bringer16::palette);
@@ -194,51 +440,112 @@ void Terminal::initialize(Mouse_mode mouse_mode,
     is_initialized_ = true;
 }
 
+void Terminal::initialize(Terminal_sink& s)
+{
+    if (is_initialized_)
+        return;
+    sink                      = &s;
+    has_repeat_               = true;
+    has_palette_redefinition_ = true;
+    has_bce_                  = true;
+    encoder.set_repeat(has_repeat_);
+    encoder.set_erase(has_bce_);
+    Terminal::set_palette(dawn_bringer16::palette);
+    screen_buffers.resize(Terminal::area());
+    is_initialized_ = true;
+}
+
 void Terminal::uninitialize()
 {
     if (!is_initialized_)
         return;
-    ::esc::uninitialize_terminal();
+    release_palette_slots();
+    if (sink == nullptr)
+        ::esc::uninitialize_terminal();
+    sink            = nullptr;
     is_initialized_ = false;
 }
 
-auto Terminal::area() -> Area { return ::esc::terminal_area(); }
+auto Terminal::area() -> Area
+{
+    return sink != nullptr ? sink->area() : ::esc::terminal_area();
+}
 
 void Terminal::refresh()
 {
+    auto stats          = Render_stats{};
+    stats.frame         = ++frame_count_;
+    stats.cells_diffed  = count_dirty_cells(screen_buffers.next);
+    stats.cells_painted = screen_buffers.next.write_count();
+    stats.full_repaint  = full_repaint_;
+    auto const start    = Clock_t::now();
     if (full_repaint_) {
         screen_buffers.merge();
-        esc::write(to_escape_sequence(screen_buffers.current_screen_as_diff()));
+        auto const& diff = screen_buffers.current_screen_as_diff();
+        stats.merge_time = Clock_t::now() - start;
+        write_frame(diff, Terminal::is_synchronized_output(), std::nullopt,
+                    &stats);
         full_repaint_ = false;
     }
-    else
-        esc::write(to_escape_sequence(screen_buffers.merge_and_diff()));
-    esc::flush();
-    screen_buffers.next.reset();
+    else {
+        // Scrolled content is moved by the terminal, not retransmitted.
+        auto const shift = screen_buffers.find_vertical_shift();
+        if (shift.has_value())
+            screen_buffers.apply_vertical_shift(*shift);
+        auto const& diff = screen_buffers.merge_and_diff();
+        stats.merge_time = Clock_t::now() - start;
+        write_frame(diff, Terminal::is_synchronized_output(), shift, &stats);
+    }
+    screen_buffers.next.reset_dirty();
+    frame_stats.store(stats);
+    frame_rendered(stats);
+}
+
+auto Terminal::last_frame_stats() -> Render_stats
+{
+    return frame_stats.load();
 }
 
 void Terminal::update_color_stores(Color c, True_color tc)
 {
-    fg_store[c] = esc::escape(foreground(tc));
-    bg_store[c] = esc::escape(background(tc));
+    if (auto const iter = palette_slots.find(c); iter != palette_slots.end())
+        redefine_palette_slot(iter->second, tc);
+    else
+        encoder.set_color_sequences(c, tc);
 }
 
 void Terminal::repaint_color(Color c)
 {
-    esc::write(to_escape_sequence(screen_buffers.generate_color_diff(c)));
-    esc::flush();
+    if (palette_slots.count(c) != 0)
+        return;
+    write_frame(screen_buffers.generate_color_diff(c),
+                Terminal::is_synchronized_output());
 }
 
 void Terminal::set_palette(Palette colors)
 {
     dynamic_color_engine_.clear();
+    release_palette_slots();
     palette_ = std::move(colors);
+    auto const redefine = palette_redefinition_ && has_palette_redefinition_ &&
+                          Terminal::color_count() >= 256;
     for (auto const& [color, color_type] : palette_) {
-        auto [fg, bg] = std::visit(
-            [&](auto const& x) { return color_sequences(x); }, color_type);
-        fg_store[color] = fg;
-        bg_store[color] = bg;
-        if (std::holds_alternative<Dynamic_color>(color_type)) {
+        auto const* const dynamic = std::get_if<Dynamic_color>(&color_type);
+        auto const slot =
+            dynamic != nullptr && redefine ? find_free_palette_slot(palette_)
+                                           : std::nullopt;
+        if (slot.has_value()) {
+            palette_slots[color] = *slot;
+            redefine_palette_slot(*slot, dynamic->get_value());
+            auto const [fg, bg] = color_sequences(Color_index{*slot});
+            encoder.set_color_sequences(color, fg, bg);
+        }
+        else {
+            auto const [fg, bg] = std::visit(
+                [&](auto const& x) { return color_sequences(x); }, color_type);
+            encoder.set_color_sequences(color, fg, bg);
+        }
+        if (dynamic != nullptr) {
             dynamic_color_engine_.start();  // no-op if already running
             dynamic_color_engine_.register_color(
                 color, std::get<Dynamic_color>(color_type));
@@ -266,27 +573,75 @@ auto Terminal::current_palette() -> Palette const& { return palette_; }
 
 void Terminal::show_cursor(bool show)
 {
+    if (sink != nullptr) {
+        write_all(show ? "\033[?25h" : "\033[?25l");
+        return;
+    }
     ::esc::set(show ? ::esc::Cursor::Show : ::esc::Cursor::Hide);
     ::esc::flush();
 }
 
 void Terminal::move_cursor(Point point)
 {
+    if (sink != nullptr) {
+        write_all(::esc::escape(::esc::Cursor_position{point}));
+        return;
+    }
     ::esc::write(::esc::escape(::esc::Cursor_position{point}));
     ::esc::flush();
 }
 
 auto Terminal::color_count() -> std::uint16_t
 {
-    return ::esc::color_palette_size();
+    return sink != nullptr ? 256 : ::esc::color_palette_size();
 }
 
-auto Terminal::has_true_color() -> bool { return ::esc::has_true_color(); }
+auto Terminal::has_true_color() -> bool
+{
+    return sink != nullptr || ::esc::has_true_color();
+}
+
+auto Terminal::wait_for_input(int wakeup_fd) -> bool
+{
+    if (sink != nullptr)
+        return true;
+    // Input already parsed or buffered is not visible to poll().
+    if (!read_ahead.has_value())
+        read_ahead = ::esc::read(0);
+    if (read_ahead.has_value())
+        return true;
+    auto fds = std::array<::pollfd, 2>{::pollfd{STDIN_FILENO, POLLIN, 0},
+                                       ::pollfd{wakeup_fd, POLLIN, 0}};
+    // Signals like SIGWINCH interrupt poll(), read_input() reports those.
+    if (::poll(fds.data(), fds.size(), -1) < 0)
+        return true;
+    return (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+}
 
 auto Terminal::read_input() -> Event
 {
+    auto const read = [] {
+        if (sink != nullptr)
+            return sink->read();
+        if (read_ahead.has_value())
+            return *std::exchange(read_ahead, std::nullopt);
+        return ::esc::read();
+    };
     return std::visit([](auto const& event) { return transform(event); },
-                      ::esc::read());
+                      read());
+}
+
+auto Terminal::read_pending_input() -> std::optional<Event>
+{
+    auto e = std::optional<::esc::Event>{};
+    if (sink == nullptr)
+        e = try_read_stdin();
+    else if (sink->has_input())
+        e = sink->read();
+    if (!e.has_value())
+        return std::nullopt;
+    return std::visit([](auto x) { return transform_ahead(std::move(x)); },
+                      std::move(*e));
 }
 
 void Terminal::flag_full_repaint() { full_repaint_ = true; }
@@ -303,6 +658,35 @@ void Terminal::flush_screen()
     }
 }
 
+void Terminal::set_synchronized_output(bool enable)
+{
+    synchronized_output_ = enable;
+}
+
+auto Terminal::is_synchronized_output() -> bool
+{
+    return synchronized_output_ && has_synchronized_output_;
+}
+
+auto Terminal::has_synchronized_output() -> bool
+{
+    return has_synchronized_output_;
+}
+
+void Terminal::set_palette_redefinition(bool enable)
+{
+    palette_redefinition_ = enable;
+}
+
+auto Terminal::has_palette_redefinition() -> bool
+{
+    return has_palette_redefinition_;
+}
+
+auto Terminal::has_repeat() -> bool { return has_repeat_; }
+
+auto Terminal::has_bce() -> bool { return has_bce_; }
+
 void Terminal::stop_dynamic_color_engine() { dynamic_color_engine_.stop(); }
 
 void Terminal::handle_signint(bool const x) { handle_sigint_ = x; }
@@ -3,6 +3,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <utility>
@@ -13,6 +14,7 @@
 #include <termox/painter/glyph.hpp>
 #include <termox/system/event.hpp>
 #include <termox/system/system.hpp>
+#include <termox/terminal/detail/canvas.hpp>
 #include <termox/terminal/terminal.hpp>
 
 namespace {
@@ -93,6 +95,7 @@ void Widget::enable(bool enable)
     if (!enable)
         System::post_event(Disable_event{*this});
     enabled_ = enable;
+    this->invalidate_parent_paint_cache();
     if (enable)
         System::post_event(Enable_event{*this});
 }
@@ -107,7 +110,11 @@ auto Widget::top_left() const -> Point { return top_left_position_; }
 
 auto Widget::area() const -> Area { return area_; }
 
-void Widget::update() { System::post_event(Paint_event{*this}); }
+void Widget::update()
+{
+    paint_cache_valid_ = false;
+    System::post_event(Paint_event{*this});
+}
 
 auto Widget::is_layout_type() const -> bool { return false; }
 
@@ -193,6 +200,22 @@ auto Widget::generate_wallpaper() const -> Glyph
     return bg_glyph;
 }
 
+void Widget::enable_paint_cache(bool enable)
+{
+    if (enable && paint_cache_ == nullptr)
+        paint_cache_ = std::make_unique<detail::Canvas>(this->area());
+    else if (!enable)
+        paint_cache_ = nullptr;
+    paint_cache_valid_ = false;
+    this->update();
+}
+
+auto Widget::has_paint_cache() const -> bool { return paint_cache_ != nullptr; }
+
+void Widget::enable_raw_mouse_input(bool enable) { raw_mouse_input_ = enable; }
+
+auto Widget::has_raw_mouse_input() const -> bool { return raw_mouse_input_; }
+
 auto Widget::get_child_offset() const -> std::size_t { return child_offset_; }
 
 auto Widget::child_count() const -> std::size_t { return children_.size(); }
@@ -217,7 +240,8 @@ auto Widget::child_polished_event(Widget&) -> bool
 
 auto Widget::move_event(Point, Point) -> bool
 {
-    this->update();
+    // Moving does not change what is painted, the paint cache stays valid.
+    System::post_event(Paint_event{*this});
     return true;
 }
 
@@ -306,11 +330,57 @@ auto Widget::paint_event_filter(Widget&, Painter&) -> bool { return false; }
 
 auto Widget::timer_event_filter(Widget&) -> bool { return false; }
 
-void Widget::set_top_left(Point p) { top_left_position_ = p; }
+void Widget::set_top_left(Point p)
+{
+    top_left_position_ = p;
+    this->invalidate_parent_paint_cache();
+}
 
-void Widget::set_area(Area a) { area_ = a; }
+void Widget::set_area(Area a)
+{
+    area_ = a;
+    this->invalidate_parent_paint_cache();
+}
 
-void Widget::set_parent(Widget* parent) { parent_ = parent; }
+void Widget::set_parent(Widget* parent)
+{
+    // Both the old and the new parent leave different cells to children.
+    this->invalidate_parent_paint_cache();
+    parent_ = parent;
+    this->invalidate_parent_paint_cache();
+}
+
+auto Widget::stamp_paint(std::uint64_t generation) -> bool
+{
+    return paint_stamp_.exchange(generation, std::memory_order_relaxed) !=
+           generation;
+}
+
+void Widget::invalidate_parent_paint_cache()
+{
+    if (parent_ != nullptr)
+        parent_->paint_cache_valid_ = false;
+}
+
+auto Widget::valid_paint_cache() const -> detail::Canvas const*
+{
+    if (paint_cache_ == nullptr || !paint_cache_valid_ ||
+        paint_cache_->area() != this->area()) {
+        return nullptr;
+    }
+    return paint_cache_.get();
+}
+
+auto Widget::reset_paint_cache() -> detail::Canvas*
+{
+    if (paint_cache_ == nullptr)
+        return nullptr;
+    if (paint_cache_->area() != this->area())
+        paint_cache_->resize(this->area());
+    paint_cache_->reset();
+    paint_cache_valid_ = true;
+    return paint_cache_.get();
+}
 
 auto widget(std::string name,
             Focus_policy focus_policy,
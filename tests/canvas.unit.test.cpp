@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <clocale>
+#include <cstdint>
+#include <random>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -6,6 +10,7 @@
 #include <termox/painter/glyph.hpp>
 #include <termox/painter/trait.hpp>
 #include <termox/terminal/detail/canvas.hpp>
+#include <termox/terminal/detail/color_usage.hpp>
 
 void init() { std::setlocale(LC_ALL, "en_US.UTF-8"); }
 
@@ -78,3 +83,342 @@ TEST_CASE("Canvas: Everything", "[Canvas]")
     CHECK(diff.at(2).first == ox::Point{3, 16});
     CHECK(diff.at(2).second == ox::Glyph{U'x', bg(ox::Color::Blue)});
 }
+
+TEST_CASE("Canvas: Dirty Spans", "[Canvas]")
+{
+    auto next    = ox::detail::Canvas{{300, 100}};
+    auto current = ox::detail::Canvas{{300, 100}};
+    next.reset();
+
+    CHECK(next.dirty_rows().begin >= next.dirty_rows().end);
+
+    next.at({20, 7})  = ox::Glyph{U'a'};
+    next.at({4, 7})   = ox::Glyph{U'b'};
+    next.at({250, 9}) = ox::Glyph{U'c'};
+
+    CHECK(next.dirty_rows().begin == 7);
+    CHECK(next.dirty_rows().end == 10);
+    CHECK(next.dirty_span(7).begin == 4);
+    CHECK(next.dirty_span(7).end == 21);
+    CHECK(next.dirty_span(8).begin >= next.dirty_span(8).end);
+    CHECK(next.dirty_span(9).begin == 250);
+    CHECK(next.dirty_span(9).end == 251);
+
+    auto diff = ox::detail::Canvas::Diff{};
+    merge_and_diff(next, current, diff);
+    REQUIRE(diff.size() == 3);
+    CHECK(diff.at(0).first == ox::Point{4, 7});
+    CHECK(diff.at(1).first == ox::Point{20, 7});
+    CHECK(diff.at(2).first == ox::Point{250, 9});
+
+    next.reset_dirty();
+    CHECK(next.dirty_rows().begin >= next.dirty_rows().end);
+    CHECK(next.dirty_span(7).begin >= next.dirty_span(7).end);
+    CHECK(std::all_of(std::cbegin(next), std::cend(next),
+                      [](ox::Glyph g) { return g == ox::Glyph{}; }));
+
+    next.resize({10, 10});
+    CHECK(next.dirty_rows().begin == 0);
+    CHECK(next.dirty_rows().end == 10);
+    CHECK(next.dirty_span(3).begin == 0);
+    CHECK(next.dirty_span(3).end == 10);
+}
+
+TEST_CASE("Canvas: Resize to Increasing Heights", "[Canvas]")
+{
+    auto c = ox::detail::Canvas{{4, 2}};
+    c.at({3, 1}) = ox::Glyph{U'a'};
+
+    // Each resize copies into a buffer that was sized by the previous one.
+    c.resize({4, 5});
+    c.at({3, 4}) = ox::Glyph{U'b'};
+    c.resize({4, 9});
+    c.resize({4, 14});
+
+    CHECK(c.area() == ox::Area{4, 14});
+    CHECK(c.at({3, 1}).symbol == U'a');
+    CHECK(c.at({3, 4}).symbol == U'b');
+    CHECK(c.at({3, 13}) == ox::Glyph{});
+    CHECK(c.dirty_rows().end == 14);
+    CHECK(c.dirty_span(13).end == 4);
+}
+
+TEST_CASE("Canvas: Fill Row", "[Canvas]")
+{
+    auto next = ox::detail::Canvas{{30, 5}};
+    next.reset();
+
+    next.at({25, 2}) = ox::Glyph{U'a'};
+    next.fill_row({3, 2}, 10, ox::Glyph{U'-'});
+    next.fill_row({0, 4}, 0, ox::Glyph{U'x'});
+
+    CHECK(next.dirty_rows().begin == 2);
+    CHECK(next.dirty_rows().end == 3);
+    CHECK(next.dirty_span(2).begin == 3);
+    CHECK(next.dirty_span(2).end == 26);
+    CHECK(next.write_count() == 11);
+    CHECK(next.at({2, 2}) == ox::Glyph{});
+    CHECK(next.at({3, 2}) == ox::Glyph{U'-'});
+    CHECK(next.at({12, 2}) == ox::Glyph{U'-'});
+    CHECK(next.at({13, 2}) == ox::Glyph{});
+
+    next.reset_dirty();
+    CHECK(next.write_count() == 0);
+    CHECK(std::all_of(std::cbegin(next), std::cend(next),
+                      [](ox::Glyph g) { return g == ox::Glyph{}; }));
+}
+
+TEST_CASE("Canvas: Blit", "[Canvas]")
+{
+    auto src = ox::detail::Canvas{{4, 2}};
+    src.reset();
+    src.fill_row({0, 0}, 4, ox::Glyph{U'a'});
+    src.at({1, 1}) = ox::Glyph{U'b'};
+    src.at({3, 1}) = ox::Glyph{U'c'};
+
+    auto dest = ox::detail::Canvas{{6, 3}};
+    dest.reset();
+    dest.fill_row({0, 2}, 6, ox::Glyph{U'z'});
+    dest.blit(src, {3, 1});
+
+    auto const& view = dest;
+    CHECK(view.at({2, 1}) == ox::Glyph{});
+    CHECK(view.at({3, 1}) == ox::Glyph{U'a'});
+    CHECK(view.at({5, 1}) == ox::Glyph{U'a'});
+    CHECK(view.at({3, 2}) == ox::Glyph{U'z'});
+    CHECK(view.at({4, 2}) == ox::Glyph{U'b'});
+    CHECK(view.at({5, 2}) == ox::Glyph{U'z'});
+    CHECK(view.dirty_rows().begin == 1);
+    CHECK(view.dirty_rows().end == 3);
+    CHECK(view.dirty_span(1).begin == 3);
+    CHECK(view.dirty_span(1).end == 6);
+}
+
+TEST_CASE("Canvas: Merge Kernels", "[Canvas]")
+{
+    using ox::detail::Merge_kernel;
+    auto const area = ox::Area{123, 45};
+    auto gen        = std::mt19937{42};
+    auto percent    = std::uniform_int_distribution{0, 99};
+    auto rolls      = std::vector<int>{};
+    for (auto i = 0; i < area.width * area.height; ++i)
+        rolls.push_back(percent(gen));
+
+    // Mix of untouched, unchanged, and changed cells, with odd row lengths.
+    auto next = ox::detail::Canvas{area};
+    for (auto i = 0; i < area.width * area.height; ++i) {
+        auto const p = ox::Point{i % area.width, i / area.width};
+        if (rolls[i] < 15)
+            next.at(p) = ox::Glyph{U'a', fg(ox::Color::Red)};
+        else if (rolls[i] < 20)
+            next.at(p) = ox::Glyph{U'a', bg(ox::Color::Red)};
+        else if (rolls[i] < 25)
+            next.at(p) = ox::Glyph{U'b', fg(ox::Color::Red)};
+    }
+    auto const make_current = [&] {
+        auto current = ox::detail::Canvas{area};
+        for (auto i = 0; i < area.width * area.height; ++i) {
+            if (rolls[i] < 30) {
+                current.at({i % area.width, i / area.width}) =
+                    ox::Glyph{U'a', fg(ox::Color::Red)};
+            }
+        }
+        return current;
+    };
+
+    ox::detail::set_merge_kernel(Merge_kernel::Scalar);
+    auto expected_current = make_current();
+    auto expected_diff    = ox::detail::Canvas::Diff{};
+    merge_and_diff(next, expected_current, expected_diff);
+    CHECK(!expected_diff.empty());
+
+    for (auto k : {Merge_kernel::SSE2, Merge_kernel::AVX2}) {
+        if (!ox::detail::is_supported(k))
+            continue;
+        ox::detail::set_merge_kernel(k);
+        auto current = make_current();
+        auto diff    = ox::detail::Canvas::Diff{};
+        merge_and_diff(next, current, diff);
+        REQUIRE(diff.size() == expected_diff.size());
+        for (auto i = 0uL; i < diff.size(); ++i) {
+            CHECK(diff[i].first == expected_diff[i].first);
+            CHECK(diff[i].second == expected_diff[i].second);
+        }
+        CHECK(std::equal(std::cbegin(current), std::cend(current),
+                         std::cbegin(expected_current)));
+    }
+    ox::detail::set_merge_kernel(ox::detail::best_merge_kernel());
+}
+
+TEST_CASE("Canvas: Vertical Shift", "[Canvas]")
+{
+    // A log in rows [1, 7) with a static status line on row 7.
+    auto const area = ox::Area{6, 8};
+    auto const line = [](int n) {
+        return ox::Glyph{static_cast<char32_t>(U'a' + n), fg(ox::Color::Green)};
+    };
+    auto const paint_log = [&](ox::detail::Canvas& c, int first_line) {
+        for (auto y = 1; y < 7; ++y) {
+            for (auto x = 0; x < area.width; ++x)
+                c.at({x, y}) = line(first_line + y);
+        }
+        for (auto x = 0; x < area.width; ++x)
+            c.at({x, 7}) = ox::Glyph{U'-'};
+    };
+
+    // After the shift and merge, current is unchanged from a plain merge.
+    auto const check_merged = [&](ox::detail::Canvas const& next,
+                                  ox::detail::Canvas const& current) {
+        for (auto y = 0; y < area.height; ++y) {
+            for (auto x = 0; x < area.width; ++x) {
+                auto const expected = next.at({x, y}).symbol != U'\0'
+                                          ? next.at({x, y})
+                                          : current.at({x, y});
+                CHECK(current.at({x, y}) == expected);
+            }
+        }
+    };
+
+    auto current = ox::detail::Canvas{area};
+    auto next    = ox::detail::Canvas{area};
+    auto diff    = ox::detail::Canvas::Diff{};
+    auto hashes  = std::vector<std::uint64_t>{};
+    paint_log(next, 0);
+    merge_and_diff(next, current, diff);
+    next.reset_dirty();
+
+    SECTION("Scroll up by one line")
+    {
+        paint_log(next, 1);
+        auto const shift = find_vertical_shift(next, current, hashes);
+        REQUIRE(shift.has_value());
+        CHECK(shift->top == 1);
+        CHECK(shift->bottom == 7);
+        CHECK(shift->distance == 1);
+
+        apply_vertical_shift(*shift, next, current);
+        merge_and_diff(next, current, diff);
+        CHECK((int)diff.size() == area.width);
+        for (auto const& [point, glyph] : diff) {
+            CHECK(point.y == 6);
+            CHECK(glyph == line(7));
+        }
+        check_merged(next, current);
+    }
+
+    SECTION("Scroll down by two lines")
+    {
+        paint_log(next, -2);
+        auto const shift = find_vertical_shift(next, current, hashes);
+        REQUIRE(shift.has_value());
+        CHECK(shift->top == 1);
+        CHECK(shift->bottom == 7);
+        CHECK(shift->distance == -2);
+
+        apply_vertical_shift(*shift, next, current);
+        merge_and_diff(next, current, diff);
+        CHECK((int)diff.size() == area.width * 2);
+        for (auto const& [point, glyph] : diff)
+            CHECK((point.y == 1 || point.y == 2));
+        check_merged(next, current);
+    }
+
+    SECTION("Unrelated changes are not a shift")
+    {
+        for (auto x = 0; x < area.width; ++x) {
+            next.at({x, 2}) = ox::Glyph{U'#'};
+            next.at({x, 4}) = ox::Glyph{U'#'};
+        }
+        CHECK(!find_vertical_shift(next, current, hashes).has_value());
+    }
+
+    SECTION("Sparse changes are not searched")
+    {
+        next.at({0, 0}) = ox::Glyph{U'#'};
+        next.at({area.width - 1, area.height - 1}) = ox::Glyph{U'#'};
+        CHECK(!find_vertical_shift(next, current, hashes).has_value());
+        CHECK(hashes.empty());
+    }
+}
+
+TEST_CASE("Canvas: Color Usage", "[Canvas]")
+{
+    auto const area = ox::Area{23, 11};
+    auto const colors =
+        std::vector{ox::Color::Red, ox::Color::Blue, ox::Color::Green};
+    auto gen     = std::mt19937{3};
+    auto roll    = std::uniform_int_distribution{0, 99};
+    auto pick    = std::uniform_int_distribution{0, 2};
+    auto current = ox::detail::Canvas{area};
+    auto next    = ox::detail::Canvas{area};
+    auto usage   = ox::detail::Color_usage{};
+    auto diff    = ox::detail::Canvas::Diff{};
+    auto scanned = ox::detail::Canvas::Diff{};
+    usage.rebuild(current);
+
+    auto const check_all_colors = [&] {
+        for (auto c : colors) {
+            generate_color_diff(c, current, usage, diff);
+            generate_color_diff(c, current, scanned);
+            REQUIRE(diff.size() == scanned.size());
+            for (auto i = 0uL; i < diff.size(); ++i) {
+                CHECK(diff[i].first == scanned[i].first);
+                CHECK(diff[i].second == scanned[i].second);
+            }
+        }
+    };
+
+    for (auto frame = 0; frame < 8; ++frame) {
+        for (auto y = 0; y < area.height; ++y) {
+            for (auto x = 0; x < area.width; ++x) {
+                if (roll(gen) < 40) {
+                    next.at({x, y}) = ox::Glyph{U'x', fg(colors[pick(gen)]),
+                                                bg(colors[pick(gen)])};
+                }
+            }
+        }
+        if (frame % 2 == 0)
+            merge(next, current, &usage);
+        else
+            merge_and_diff(next, current, diff, &usage);
+        next.reset_dirty();
+        check_all_colors();
+    }
+
+    apply_vertical_shift({2, 9, 3}, next, current);
+    usage.recount(current, {2, 9});
+    check_all_colors();
+}
+
+TEST_CASE("Canvas: Color Usage Columns", "[Canvas]")
+{
+    auto current = ox::detail::Canvas{{20, 2}};
+    auto next    = ox::detail::Canvas{{20, 2}};
+    auto usage   = ox::detail::Color_usage{};
+    auto diff    = ox::detail::Canvas::Diff{};
+    usage.rebuild(current);
+
+    next.at({4, 1})  = ox::Glyph{U'a', fg(ox::Color::Red)};
+    next.at({9, 1})  = ox::Glyph{U'b', fg(ox::Color::Red)};
+    next.at({15, 1}) = ox::Glyph{U'c', fg(ox::Color::Blue)};
+    merge(next, current, &usage);
+    next.reset_dirty();
+    CHECK(!usage.is_used(ox::Color::Red, 0));
+    CHECK(usage.columns(ox::Color::Red, 1).begin == 4);
+    CHECK(usage.columns(ox::Color::Red, 1).end == 10);
+
+    generate_color_diff(ox::Color::Red, current, usage, diff);
+    REQUIRE(diff.size() == 2);
+    CHECK(diff[0].first == ox::Point{4, 1});
+    CHECK(diff[1].first == ox::Point{9, 1});
+
+    // The columns are dropped once the row has no Glyph with the Color left.
+    next.at({4, 1}) = ox::Glyph{U'a', fg(ox::Color::Blue)};
+    next.at({9, 1}) = ox::Glyph{U'b', fg(ox::Color::Blue)};
+    merge(next, current, &usage);
+    CHECK(!usage.is_used(ox::Color::Red, 1));
+    CHECK(usage.columns(ox::Color::Red, 1).begin >=
+          usage.columns(ox::Color::Red, 1).end);
+    CHECK(usage.columns(ox::Color::Blue, 1).begin == 4);
+    CHECK(usage.columns(ox::Color::Blue, 1).end == 16);
+}
@@ -0,0 +1,153 @@
+#include <termox/terminal/detail/canvas.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/widget/area.hpp>
+
+// Times merge_and_diff() for each Merge_kernel on fully dirty canvases from 4K
+// to 100K cells, with a small fraction of cells changing between frames. Then
+// times find_vertical_shift() on a sparse frame, where it finds nothing, and
+// on a frame where every row has scrolled up by one.
+
+namespace {
+
+using ox::detail::Canvas;
+using ox::detail::Merge_kernel;
+using Clock_t = std::chrono::steady_clock;
+
+/// Fill every cell of \p c, with \p percent_changed cells differing per seed.
+void paint(Canvas& c, unsigned seed, int percent_changed)
+{
+    auto gen     = std::mt19937{seed};
+    auto percent = std::uniform_int_distribution{0, 99};
+    auto const a = c.area();
+    for (auto y = 0; y < a.height; ++y) {
+        for (auto x = 0; x < a.width; ++x) {
+            auto const changed = percent(gen) < percent_changed;
+            c.at({x, y}) = changed ? ox::Glyph{U'x', fg(ox::Color::Red)}
+                                   : ox::Glyph{U' ', bg(ox::Color::Black)};
+        }
+    }
+}
+
+/// Return the average nanoseconds per merge_and_diff() call.
+auto time_kernel(Merge_kernel k, ox::Area a, int iterations) -> double
+{
+    ox::detail::set_merge_kernel(k);
+    auto frame_a = Canvas{a};
+    auto frame_b = Canvas{a};
+    auto current = Canvas{a};
+    paint(frame_a, 1, 2);
+    paint(frame_b, 2, 2);
+    auto diff = Canvas::Diff{};
+    merge_and_diff(frame_a, current, diff);
+
+    // Alternating frames keeps the number of changed cells constant.
+    auto const start = Clock_t::now();
+    for (auto i = 0; i < iterations; ++i)
+        merge_and_diff(i % 2 == 0 ? frame_b : frame_a, current, diff);
+    auto const elapsed = std::chrono::duration<double, std::nano>{
+        Clock_t::now() - start};
+    return elapsed.count() / iterations;
+}
+
+/// Return the average nanoseconds per find_vertical_shift() call.
+/** If \p scrolled, every row of the next frame is the current frame's row
+ *  below it, otherwise only the top left and bottom right cells change. */
+auto time_shift_search(ox::Area a, bool scrolled, int iterations) -> double
+{
+    auto next    = Canvas{a};
+    auto current = Canvas{a};
+    paint(current, 1, 50);
+    if (scrolled) {
+        for (auto y = 0; y < a.height; ++y) {
+            for (auto x = 0; x < a.width; ++x)
+                next.at({x, y}) = current.at({x, (y + 1) % a.height});
+        }
+    }
+    else {
+        next.at({0, 0})                      = ox::Glyph{U'#'};
+        next.at({a.width - 1, a.height - 1}) = ox::Glyph{U'#'};
+    }
+    auto hashes = std::vector<std::uint64_t>{};
+
+    auto found       = 0;
+    auto const start = Clock_t::now();
+    for (auto i = 0; i < iterations; ++i)
+        found += find_vertical_shift(next, current, hashes).has_value();
+    auto const elapsed = std::chrono::duration<double, std::nano>{
+        Clock_t::now() - start};
+    if (found != (scrolled ? iterations : 0))
+        std::cerr << "unexpected find_vertical_shift() result\n";
+    return elapsed.count() / iterations;
+}
+
+auto to_string(Merge_kernel k) -> std::string
+{
+    switch (k) {
+        case Merge_kernel::Scalar: return "scalar";
+        case Merge_kernel::SSE2: return "sse2";
+        case Merge_kernel::AVX2: return "avx2";
+    }
+    return "";
+}
+
+}  // namespace
+
+int main()
+{
+    auto const areas = {ox::Area{64, 64}, ox::Area{160, 100},
+                        ox::Area{250, 200}, ox::Area{400, 250}};
+    auto const kernels = {Merge_kernel::Scalar, Merge_kernel::SSE2,
+                          Merge_kernel::AVX2};
+
+    std::cout << std::setw(10) << "cells";
+    for (auto k : kernels)
+        std::cout << std::setw(12) << (to_string(k) + " ns");
+    std::cout << std::setw(10) << "speedup" << '\n';
+
+    for (auto a : areas) {
+        auto const cells = a.width * a.height;
+        std::cout << std::setw(10) << cells;
+        auto const iterations = 20'000'000 / cells;
+        auto scalar           = 0.;
+        auto best             = 0.;
+        for (auto k : kernels) {
+            if (!ox::detail::is_supported(k)) {
+                std::cout << std::setw(12) << "n/a";
+                continue;
+            }
+            auto const ns = time_kernel(k, a, iterations);
+            if (k == Merge_kernel::Scalar)
+                scalar = ns;
+            best = ns;
+            std::cout << std::setw(12) << std::fixed << std::setprecision(0)
+                      << ns;
+        }
+        std::cout << std::setw(10) << std::setprecision(2) << scalar / best
+                  << '\n';
+    }
+    ox::detail::set_merge_kernel(ox::detail::best_merge_kernel());
+
+    std::cout << '\n'
+              << std::setw(10) << "cells" << std::setw(14) << "sparse ns"
+              << std::setw(14) << "scrolled ns" << '\n';
+    for (auto a : areas) {
+        auto const cells      = a.width * a.height;
+        auto const iterations = 20'000'000 / cells;
+        std::cout << std::setw(10) << cells << std::setw(14) << std::fixed
+                  << std::setprecision(0)
+                  << time_shift_search(a, false, iterations * 100)
+                  << std::setw(14) << time_shift_search(a, true, iterations)
+                  << '\n';
+    }
+}
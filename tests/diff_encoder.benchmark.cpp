@@ -0,0 +1,156 @@
+#include <termox/terminal/detail/diff_encoder.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+
+#include <esc/esc.hpp>
+
+#include <termox/common/u32_to_mb.hpp>
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/painter/trait.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+
+// Compares the number of bytes written per frame by the stateful Diff_encoder
+// against writing a cursor position, traits and colors for every cell, and
+// counts heap allocations per frame once the output buffer has warmed up.
+
+namespace {
+
+auto allocation_count = std::size_t{0};
+
+}  // namespace
+
+auto operator new(std::size_t size) -> void*
+{
+    ++allocation_count;
+    if (auto* const p = std::malloc(size == 0 ? 1 : size); p != nullptr)
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using ox::detail::Canvas;
+
+/// Return a Diff_encoder with Color_index sequences set for Colors [0, 16).
+auto make_encoder() -> ox::detail::Diff_encoder
+{
+    auto encoder = ox::detail::Diff_encoder{};
+    for (auto i = std::uint8_t{0}; i < 16; ++i) {
+        encoder.set_color_sequences(
+            ox::Color{i}, esc::escape(esc::foreground(ox::Color_index{i})),
+            esc::escape(esc::background(ox::Color_index{i})));
+    }
+    return encoder;
+}
+
+/// Every cell gets a cursor position, traits and colors.
+auto per_cell_bytes(Canvas::Diff const& diff) -> std::size_t
+{
+    auto count = std::size_t{0};
+    for (auto const& [point, glyph] : diff) {
+        auto const fg = ox::Color_index{glyph.brush.foreground.value};
+        auto const bg = ox::Color_index{glyph.brush.background.value};
+        count += esc::escape(esc::Cursor_position{point}).size();
+        count += esc::escape(glyph.brush.traits).size();
+        count += esc::escape(esc::foreground(fg)).size();
+        count += esc::escape(esc::background(bg)).size();
+        count += ox::u32_to_mb(glyph.symbol).size();
+    }
+    return count;
+}
+
+/// Full screen of text, a few Brushes per row.
+auto full_screen(ox::Area a) -> Canvas::Diff
+{
+    auto diff = Canvas::Diff{};
+    for (auto y = 0; y < a.height; ++y) {
+        for (auto x = 0; x < a.width; ++x) {
+            auto const letter = static_cast<char32_t>(U'a' + x % 26);
+            auto const glyph  = (x % 40) < 12
+                                   ? ox::Glyph{letter, fg(ox::Color::Yellow),
+                                               ox::Trait::Bold}
+                                   : ox::Glyph{U' ', bg(ox::Color::Dark_blue)};
+            diff.push_back({{x, y}, glyph});
+        }
+    }
+    return diff;
+}
+
+/// Dashboard update, short horizontal runs of changing numbers.
+auto dashboard(ox::Area a) -> Canvas::Diff
+{
+    auto diff = Canvas::Diff{};
+    for (auto y = 1; y < a.height; y += 2) {
+        for (auto panel = 0; panel < a.width / 40; ++panel) {
+            for (auto x = 0; x < 8; ++x) {
+                auto const digit = static_cast<char32_t>(U'0' + (x + y) % 10);
+                diff.push_back({{panel * 40 + 20 + x, y},
+                                ox::Glyph{digit, fg(ox::Color::Light_green)}});
+            }
+        }
+    }
+    return diff;
+}
+
+/// Scattered single cells, the worst case for the stateful encoder.
+auto scattered(ox::Area a) -> Canvas::Diff
+{
+    auto gen    = std::mt19937{7};
+    auto x_dist = std::uniform_int_distribution{0, a.width / 2 - 1};
+    auto diff   = Canvas::Diff{};
+    for (auto y = 0; y < a.height; ++y) {
+        auto const x = x_dist(gen) * 2;
+        diff.push_back({{x, y}, ox::Glyph{U'*', fg(ox::Color::Red)}});
+    }
+    return diff;
+}
+
+void report(std::string const& name, Canvas::Diff const& diff)
+{
+    auto encoder = make_encoder();
+    auto out     = std::string{};
+    encoder.encode(diff, out);
+    auto const before = per_cell_bytes(diff);
+    auto const after  = out.size();
+
+    // Reuse the buffer as Terminal does, the first frame above warmed it up.
+    auto constexpr frames = 100;
+    auto const start      = allocation_count;
+    for (auto i = 0; i < frames; ++i) {
+        out.clear();
+        encoder.encode(diff, out);
+    }
+    auto const allocations = (double)(allocation_count - start) / frames;
+
+    std::cout << std::left << std::setw(14) << name << std::right
+              << std::setw(8) << diff.size() << std::setw(12) << before
+              << std::setw(12) << after << std::setw(10) << std::fixed
+              << std::setprecision(2) << (double)before / (double)after
+              << std::setw(14) << allocations << '\n';
+}
+
+}  // namespace
+
+int main()
+{
+    auto const area = ox::Area{200, 50};
+    std::cout << std::left << std::setw(14) << "frame" << std::right
+              << std::setw(8) << "cells" << std::setw(12) << "per-cell"
+              << std::setw(12) << "encoder" << std::setw(10) << "ratio"
+              << std::setw(14) << "allocs/frame" << '\n';
+    report("full screen", full_screen(area));
+    report("dashboard", dashboard(area));
+    report("scattered", scattered(area));
+}
@@ -0,0 +1,195 @@
+#include <termox/terminal/detail/diff_encoder.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <esc/esc.hpp>
+
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/painter/trait.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+
+namespace {
+
+auto encoder_with_colors() -> ox::detail::Diff_encoder
+{
+    auto encoder = ox::detail::Diff_encoder{};
+    for (auto i = std::uint8_t{0}; i < 16; ++i) {
+        encoder.set_color_sequences(
+            ox::Color{i}, esc::escape(esc::foreground(ox::Color_index{i})),
+            esc::escape(esc::background(ox::Color_index{i})));
+    }
+    return encoder;
+}
+
+auto position(int x, int y) -> std::string
+{
+    return esc::escape(esc::Cursor_position{{x, y}});
+}
+
+auto brush(ox::Traits traits, int fg, int bg) -> std::string
+{
+    auto const f = ox::Color_index{static_cast<std::uint8_t>(fg)};
+    auto const b = ox::Color_index{static_cast<std::uint8_t>(bg)};
+    return esc::escape(traits) + esc::escape(esc::foreground(f)) +
+           esc::escape(esc::background(b));
+}
+
+}  // namespace
+
+TEST_CASE("Diff_encoder: adjacent cells share cursor and brush",
+          "[Diff_encoder]")
+{
+    auto encoder = encoder_with_colors();
+    auto diff    = ox::detail::Canvas::Diff{
+        {{3, 2}, ox::Glyph{U'a'}},
+        {{4, 2}, ox::Glyph{U'b'}},
+        {{5, 2}, ox::Glyph{U'c'}},
+    };
+    auto out = std::string{};
+    encoder.encode(diff, out);
+
+    auto const default_brush =
+        brush(ox::Trait::None, ox::Color::Foreground, ox::Color::Background);
+    CHECK(out == position(3, 2) + default_brush + "abc");
+}
+
+TEST_CASE("Diff_encoder: gaps and row changes move the cursor",
+          "[Diff_encoder]")
+{
+    auto encoder = encoder_with_colors();
+    auto diff    = ox::detail::Canvas::Diff{
+        {{0, 0}, ox::Glyph{U'a'}},
+        {{2, 0}, ox::Glyph{U'b'}},
+        {{3, 1}, ox::Glyph{U'c'}},
+    };
+    auto out = std::string{};
+    encoder.encode(diff, out);
+
+    auto const default_brush =
+        brush(ox::Trait::None, ox::Color::Foreground, ox::Color::Background);
+    CHECK(out == position(0, 0) + default_brush + "a" + position(2, 0) + "b" +
+                     position(3, 1) + "c");
+}
+
+TEST_CASE("Diff_encoder: only changed brush members are written",
+          "[Diff_encoder]")
+{
+    auto encoder = encoder_with_colors();
+    auto diff    = ox::detail::Canvas::Diff{
+        {{0, 0}, ox::Glyph{U'a', fg(ox::Color::Red)}},
+        {{1, 0}, ox::Glyph{U'b', fg(ox::Color::Blue)}},
+        {{2, 0}, ox::Glyph{U'c', fg(ox::Color::Blue), ox::Trait::Bold}},
+    };
+    auto out = std::string{};
+    encoder.encode(diff, out);
+
+    auto const expected =
+        position(0, 0) +
+        brush(ox::Trait::None, ox::Color::Red, ox::Color::Background) + "a" +
+        esc::escape(esc::foreground(ox::Color_index{ox::Color::Blue})) + "b" +
+        brush(ox::Trait::Bold, ox::Color::Blue, ox::Color::Background) + "c";
+    CHECK(out == expected);
+}
+
+TEST_CASE("Diff_encoder: state does not carry over between calls",
+          "[Diff_encoder]")
+{
+    auto encoder = encoder_with_colors();
+    auto diff    = ox::detail::Canvas::Diff{{{7, 7}, ox::Glyph{U'x'}}};
+    auto first   = std::string{};
+    auto second  = std::string{};
+    encoder.encode(diff, first);
+    encoder.encode(diff, second);
+    CHECK(first == second);
+}
+
+TEST_CASE("Diff_encoder: true color sequences are set in place",
+          "[Diff_encoder]")
+{
+    auto encoder = ox::detail::Diff_encoder{};
+    encoder.set_color_sequences(ox::Color{200},
+                                ox::True_color{esc::RGB{255, 0, 18}});
+    auto diff = ox::detail::Canvas::Diff{
+        {{0, 0}, ox::Glyph{U'a', fg(ox::Color{200})}},
+    };
+    auto out = std::string{};
+    encoder.encode(diff, out);
+
+    auto const expected = position(0, 0) + esc::escape(ox::Traits{ox::Trait::None}) +
+                          "\033[38;2;255;0;18m" +
+                          esc::escape(background(esc::Default_color{})) + "a";
+    CHECK(out == expected);
+}
+
+TEST_CASE("Diff_encoder: scrolls set and reset the scroll region",
+          "[Diff_encoder]")
+{
+    auto encoder = ox::detail::Diff_encoder{};
+    auto up      = std::string{};
+    auto down    = std::string{};
+    encoder.encode_scroll({2, 10, 1}, up);
+    encoder.encode_scroll({0, 5, -3}, down);
+    CHECK(up == "\033[0m\033[3;10r\033[1S\033[r");
+    CHECK(down == "\033[0m\033[1;5r\033[3T\033[r");
+}
+
+TEST_CASE("Diff_encoder: runs of blanks are erased with ECH only if enabled",
+          "[Diff_encoder]")
+{
+    auto encoder = encoder_with_colors();
+    auto diff    = ox::detail::Canvas::Diff{};
+    for (auto x = 0; x < 20; ++x)
+        diff.push_back({{x, 0}, ox::Glyph{U' '}});
+    diff.push_back({{20, 0}, ox::Glyph{U'a'}});
+    for (auto x = 0; x < 3; ++x)
+        diff.push_back({{x, 1}, ox::Glyph{U' '}});
+
+    auto const default_brush =
+        brush(ox::Trait::None, ox::Color::Foreground, ox::Color::Background);
+    auto blanks = std::string{};
+    for (auto i = 0; i < 20; ++i)
+        blanks.push_back(' ');
+
+    auto plain = std::string{};
+    encoder.encode(diff, plain);
+    CHECK(plain == position(0, 0) + default_brush + blanks + "a" +
+                       position(0, 1) + "   ");
+
+    encoder.set_erase(true);
+    auto erased = std::string{};
+    encoder.encode(diff, erased);
+    CHECK(erased == position(0, 0) + default_brush + "\033[20X\033[20Ca" +
+                        position(0, 1) + "   ");
+}
+
+TEST_CASE("Diff_encoder: runs are repeated with REP only if enabled",
+          "[Diff_encoder]")
+{
+    auto encoder = encoder_with_colors();
+    auto diff    = ox::detail::Canvas::Diff{};
+    for (auto x = 0; x < 10; ++x)
+        diff.push_back({{x, 0}, ox::Glyph{U'='}});
+    for (auto x = 0; x < 3; ++x)
+        diff.push_back({{x, 1}, ox::Glyph{U'x'}});
+
+    auto const default_brush =
+        brush(ox::Trait::None, ox::Color::Foreground, ox::Color::Background);
+    auto line = std::string{};
+    for (auto i = 0; i < 10; ++i)
+        line.push_back('=');
+
+    auto plain = std::string{};
+    encoder.encode(diff, plain);
+    CHECK(plain == position(0, 0) + default_brush + line + position(0, 1) +
+                       "xxx");
+
+    encoder.set_repeat(true);
+    auto repeated = std::string{};
+    encoder.encode(diff, repeated);
+    CHECK(repeated == position(0, 0) + default_brush + "=\033[9b" +
+                          position(0, 1) + "xxx");
+}
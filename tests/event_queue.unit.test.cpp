@@ -0,0 +1,298 @@
+#include <termox/system/event_queue.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <termox/common/thread_pool.hpp>
+#include <termox/painter/painter.hpp>
+#include <termox/system/event.hpp>
+#include <termox/system/system.hpp>
+#include <termox/terminal/headless_terminal.hpp>
+#include <termox/terminal/terminal.hpp>
+#include <termox/widget/layouts/vertical.hpp>
+#include <termox/widget/widget.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Move and Resize coalesce per receiver", "[Basic_queue]")
+{
+    auto a     = ox::Widget{};
+    auto b     = ox::Widget{};
+    auto queue = ox::detail::Basic_queue{};
+
+    queue.append(ox::Move_event{a, {1, 1}});
+    queue.append(ox::Resize_event{a, {5, 5}});
+    queue.append(ox::Move_event{b, {2, 2}});
+    queue.append(ox::Move_event{a, {3, 3}});
+    queue.append(ox::Resize_event{a, {7, 7}});
+    CHECK(queue.size() == 3);
+
+    queue.append(ox::Timer_event{a});
+    queue.append(ox::Timer_event{a});
+    CHECK(queue.size() == 5);
+}
+
+TEST_CASE("Child_polished coalesces per receiver and child", "[Basic_queue]")
+{
+    auto parent = ox::Widget{};
+    auto x      = ox::Widget{};
+    auto y      = ox::Widget{};
+    auto queue  = ox::detail::Basic_queue{};
+
+    queue.append(ox::Child_polished_event{parent, x});
+    queue.append(ox::Child_polished_event{parent, x});
+    queue.append(ox::Child_polished_event{parent, y});
+    queue.append(ox::Child_polished_event{parent, parent});
+    queue.append(ox::Child_polished_event{parent, parent});
+    CHECK(queue.size() == 3);
+}
+
+TEST_CASE("Consecutive Mouse_move_events coalesce", "[Basic_queue]")
+{
+    using Button = ox::Mouse::Button;
+    auto a       = ox::Widget{};
+    auto b       = ox::Widget{};
+    auto queue   = ox::detail::Basic_queue{};
+
+    auto const drag = [](int x) {
+        return ox::Mouse{{x, 0}, Button::Left, {}};
+    };
+    queue.append(ox::Mouse_move_event{a, drag(0)});
+    queue.append(ox::Mouse_move_event{a, drag(1)});
+    queue.append(ox::Mouse_move_event{a, drag(2)});
+    CHECK(queue.size() == 1);
+
+    queue.append(ox::Mouse_move_event{b, drag(3)});
+    queue.append(ox::Mouse_move_event{a, drag(4)});
+    CHECK(queue.size() == 3);
+
+    queue.append(ox::Mouse_move_event{a, {{5, 0}, Button::Right, {}}});
+    CHECK(queue.size() == 4);
+
+    a.enable_raw_mouse_input();
+    queue.append(ox::Mouse_move_event{a, {{6, 0}, Button::Right, {}}});
+    CHECK(queue.size() == 5);
+}
+
+TEST_CASE("Consecutive Mouse_wheel_events add counts", "[Basic_queue]")
+{
+    using Button = ox::Mouse::Button;
+    auto a       = ox::Widget{};
+    auto queue   = ox::detail::Basic_queue{};
+
+    auto const up   = ox::Mouse{{0, 0}, Button::ScrollUp, {}};
+    auto const down = ox::Mouse{{0, 0}, Button::ScrollDown, {}};
+    queue.append(ox::Mouse_wheel_event{a, up, 1});
+    queue.append(ox::Mouse_wheel_event{a, up, 1});
+    queue.append(ox::Mouse_wheel_event{a, up, 1});
+    CHECK(queue.size() == 1);
+
+    queue.append(ox::Mouse_wheel_event{a, down, 1});
+    CHECK(queue.size() == 2);
+}
+
+TEST_CASE("Mouse bursts do not coalesce across a Widget boundary",
+          "[Basic_queue]")
+{
+    using Button = ox::Mouse::Button;
+    auto left    = ox::Widget{};
+    auto right   = ox::Widget{};
+    auto queue   = ox::detail::Basic_queue{};
+
+    // A drag from left into right, the boundary is between x 1 and 2.
+    auto const at = [](int x, Button b) { return ox::Mouse{{x, 0}, b, {}}; };
+    queue.append(ox::Mouse_move_event{left, at(0, Button::Left)});
+    queue.append(ox::Mouse_move_event{left, at(1, Button::Left)});
+    queue.append(ox::Mouse_move_event{right, at(2, Button::Left)});
+    queue.append(ox::Mouse_move_event{right, at(3, Button::Left)});
+    CHECK(queue.size() == 2);
+
+    // Wheel Events at the same point, with receivers that differ.
+    queue.append(ox::Mouse_wheel_event{left, at(1, Button::ScrollUp), 1});
+    queue.append(ox::Mouse_wheel_event{right, at(1, Button::ScrollUp), 1});
+    queue.append(ox::Mouse_wheel_event{right, at(1, Button::ScrollUp), 1});
+    CHECK(queue.size() == 4);
+
+    auto moved_to = std::vector<std::pair<ox::Widget*, int>>{};
+    auto scrolls  = std::vector<ox::Widget*>{};
+    for (auto* w : {&left, &right}) {
+        w->enable();
+        w->mouse_moved.connect([&moved_to, w](ox::Mouse const& m) {
+            moved_to.push_back({w, m.at.x});
+        });
+        w->mouse_wheel_scrolled.connect(
+            [&scrolls, w](ox::Mouse const&) { scrolls.push_back(w); });
+    }
+    queue.send_all();
+    CHECK(moved_to == std::vector<std::pair<ox::Widget*, int>>{{&left, 1},
+                                                               {&right, 3}});
+    CHECK(scrolls == std::vector<ox::Widget*>{&left, &right, &right});
+}
+
+namespace {
+
+/// Records the order its instances are painted in.
+class Recorder : public ox::Widget {
+   public:
+    explicit Recorder(std::vector<Recorder const*>& log) : log_{log}
+    {
+        this->set_area({1, 1});
+        this->enable();
+    }
+
+   protected:
+    auto paint_event(ox::Painter&) -> bool override
+    {
+        log_.push_back(this);
+        return true;
+    }
+
+   private:
+    std::vector<Recorder const*>& log_;
+};
+
+/// Return the event indices of each group in \p groups.
+[[nodiscard]] auto collect(ox::detail::Paint_groups const& groups)
+    -> std::vector<std::vector<std::size_t>>
+{
+    auto result = std::vector<std::vector<std::size_t>>{};
+    for (auto g = std::size_t{0}; g < groups.size(); ++g) {
+        result.emplace_back();
+        groups.for_each(g, [&](std::size_t i) { result.back().push_back(i); });
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Paint_queue keeps one Paint_event per receiver per batch",
+          "[Paint_queue]")
+{
+    auto term = ox::Headless_terminal{{4, 4}};
+    ox::Terminal::initialize(term);
+    ox::System::set_paint_threads(0);
+    auto log   = std::vector<Recorder const*>{};
+    auto a     = Recorder{log};
+    auto b     = Recorder{log};
+    auto c     = Recorder{log};
+    auto queue = ox::detail::Paint_queue{};
+
+    queue.append(ox::Paint_event{b});
+    queue.append(ox::Paint_event{a});
+    queue.append(ox::Paint_event{b});
+    queue.append(ox::Paint_event{c});
+    queue.append(ox::Paint_event{a});
+    CHECK(queue.size() == 3);
+
+    // Sent in first-post order.
+    CHECK(queue.send_all());
+    CHECK(log == std::vector<Recorder const*>{&b, &a, &c});
+    CHECK(queue.size() == 0);
+
+    // Each batch accepts every receiver again.
+    queue.append(ox::Paint_event{a});
+    queue.append(ox::Paint_event{b});
+    queue.append(ox::Paint_event{a});
+    CHECK(queue.size() == 2);
+
+    ox::Terminal::uninitialize();
+}
+
+TEST_CASE("Paint_groups separates disjoint receivers", "[Paint_queue]")
+{
+    auto a = ox::Widget{};
+    auto b = ox::Widget{};
+    auto c = ox::Widget{};
+    a.set_top_left({0, 0});
+    a.set_area({4, 4});
+    b.set_top_left({4, 0});  // Touches a, does not overlap.
+    b.set_area({4, 4});
+    c.set_top_left({0, 4});
+    c.set_area({8, 1});
+
+    auto groups = ox::detail::Paint_groups{};
+    groups.assign({ox::Paint_event{a}, ox::Paint_event{b}, ox::Paint_event{c}});
+    CHECK(collect(groups) ==
+          std::vector<std::vector<std::size_t>>{{0}, {1}, {2}});
+}
+
+TEST_CASE("Paint_groups keeps overlapping receivers in post order",
+          "[Paint_queue]")
+{
+    auto a = ox::Widget{};
+    auto b = ox::Widget{};
+    auto c = ox::Widget{};
+    auto d = ox::Widget{};
+    // c overlaps a and b, joining them, d is apart.
+    a.set_top_left({0, 5});
+    a.set_area({2, 2});
+    b.set_top_left({6, 5});
+    b.set_area({2, 2});
+    c.set_top_left({1, 0});
+    c.set_area({6, 6});
+    d.set_top_left({20, 0});
+    d.set_area({2, 20});
+
+    auto groups = ox::detail::Paint_groups{};
+    groups.assign({ox::Paint_event{b}, ox::Paint_event{d}, ox::Paint_event{a},
+                   ox::Paint_event{c}});
+    CHECK(collect(groups) ==
+          std::vector<std::vector<std::size_t>>{{0, 2, 3}, {1}});
+}
+
+TEST_CASE("set_paint_threads can be called while events are processed",
+          "[Paint_queue]")
+{
+    // Event handlers run with the Event_queue mutex held.
+    {
+        auto const lock = std::lock_guard{ox::Event_queue::mutex()};
+        ox::System::set_paint_threads(3);
+    }
+    auto* const pool = ox::System::paint_pool();
+    REQUIRE(pool != nullptr);
+    CHECK(pool->worker_count() == 2);
+
+    ox::System::set_paint_threads(1);
+    CHECK(ox::System::paint_pool() == nullptr);
+}
+
+TEST_CASE("A Linear_layout relayout is dropped once it is destroyed",
+          "[Event_queue]")
+{
+    auto term = ox::Headless_terminal{{4, 6}};
+    ox::Terminal::initialize(term);
+    auto head    = ox::Widget{};
+    auto setup   = ox::Event_queue{};
+    auto relayed = ox::Event_queue{};
+    ox::System::set_current_queue(&setup);
+    ox::System::set_head(&head);
+
+    auto const post_relayout = [&](ox::layout::Vertical<>& layout) {
+        layout.set_area({4, 6});
+        layout.enable();
+        auto& child = layout.make_child();
+
+        // Only the relayout Custom_event is posted to relayed.
+        ox::System::set_current_queue(&relayed);
+        ox::System::send_event(ox::Child_polished_event{layout, child});
+        ox::System::set_current_queue(&setup);
+        return &child;
+    };
+
+    auto kept              = ox::layout::Vertical<>{};
+    auto const* kept_child = post_relayout(kept);
+    {
+        auto destroyed = ox::layout::Vertical<>{};
+        post_relayout(destroyed);
+    }
+    ox::System::set_current_queue(nullptr);
+    relayed.send_all();
+    CHECK(kept_child->area() == ox::Area{4, 6});
+
+    ox::System::set_current_queue(&setup);
+    ox::System::set_head(nullptr);
+    ox::System::set_current_queue(nullptr);
+    ox::Terminal::uninitialize();
+}
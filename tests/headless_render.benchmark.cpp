@@ -0,0 +1,125 @@
+#include <termox/terminal/headless_terminal.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/system/event.hpp>
+#include <termox/terminal/render_stats.hpp>
+#include <termox/terminal/terminal.hpp>
+#include <termox/widget/area.hpp>
+
+// Renders scripted frames through Terminal::refresh() into a Headless_terminal
+// and reports the bytes and write() calls per frame and the time per frame,
+// split into merge and encode from Terminal::frame_rendered. The virtual
+// screen is checked against the current Canvas after each run.
+
+namespace {
+
+using Clock_t   = std::chrono::steady_clock;
+using Painter_t = std::function<void(ox::detail::Canvas&, int)>;
+
+auto constexpr area = ox::Area{200, 50};
+
+/// Scrolling log, every row moves up one line per frame.
+void log_scroll(ox::detail::Canvas& c, int frame)
+{
+    for (auto y = 0; y < area.height; ++y) {
+        auto const line   = frame + y;
+        auto const length = (line * 7) % area.width;
+        for (auto x = 0; x < area.width; ++x) {
+            auto const letter = static_cast<char32_t>(U'a' + (line + x) % 26);
+            c.at({x, y}) = ox::Glyph{x < length ? letter : U' ',
+                                     fg(ox::Color::Light_gray)};
+        }
+    }
+}
+
+/// Static labels with a few changing numbers per panel.
+void dashboard(ox::detail::Canvas& c, int frame)
+{
+    for (auto y = 0; y < area.height; ++y) {
+        for (auto x = 0; x < area.width; ++x) {
+            auto const is_value = (x % 40) >= 20 && (x % 40) < 28 && y % 2;
+            auto const symbol =
+                is_value ? static_cast<char32_t>(U'0' + (x + y + frame) % 10)
+                         : static_cast<char32_t>(U'A' + (x % 40) % 20);
+            c.at({x, y}) = ox::Glyph{symbol, bg(ox::Color::Dark_blue)};
+        }
+    }
+}
+
+/// Return true if every symbol on \p term matches the current Canvas.
+auto matches(ox::Headless_terminal const& term) -> bool
+{
+    auto const& current = ox::Terminal::screen_buffers.current;
+    for (auto y = 0; y < area.height; ++y) {
+        for (auto x = 0; x < area.width; ++x) {
+            if (term.at({x, y}).symbol != current.at({x, y}).symbol)
+                return false;
+        }
+    }
+    return true;
+}
+
+void report(std::string const& name,
+            ox::Headless_terminal& term,
+            Painter_t const& paint,
+            bool full_repaint)
+{
+    auto constexpr frames = 500;
+    term.reset_stats();
+    auto merge    = std::chrono::nanoseconds{0};
+    auto encode   = std::chrono::nanoseconds{0};
+    auto const id = ox::Terminal::frame_rendered.connect(
+        [&](ox::Render_stats const& s) {
+            merge += s.merge_time;
+            encode += s.encode_time;
+        });
+    auto const start = Clock_t::now();
+    for (auto i = 0; i < frames; ++i) {
+        paint(ox::Terminal::screen_buffers.next, i);
+        if (full_repaint)
+            ox::Terminal::flag_full_repaint();
+        ox::Terminal::refresh();
+    }
+    auto const elapsed =
+        std::chrono::duration<double, std::micro>{Clock_t::now() - start};
+    auto const stats = term.stats();
+    ox::Terminal::frame_rendered.disconnect(id);
+    auto const per_frame = [](std::chrono::nanoseconds total) {
+        return std::chrono::duration<double, std::micro>{total}.count() /
+               frames;
+    };
+
+    std::cout << std::left << std::setw(14) << name << std::right
+              << std::setw(12) << stats.bytes / frames << std::setw(14)
+              << std::fixed << std::setprecision(2)
+              << (double)stats.writes / frames << std::setw(12)
+              << elapsed.count() / frames << std::setw(10) << per_frame(merge)
+              << std::setw(10) << per_frame(encode) << std::setw(10)
+              << (matches(term) ? "yes" : "NO") << '\n';
+}
+
+}  // namespace
+
+int main()
+{
+    auto term = ox::Headless_terminal{area};
+    ox::Terminal::initialize(term);
+
+    std::cout << std::left << std::setw(14) << "scenario" << std::right
+              << std::setw(12) << "bytes/frame" << std::setw(14)
+              << "writes/frame" << std::setw(12) << "us/frame" << std::setw(10)
+              << "merge" << std::setw(10) << "encode" << std::setw(10)
+              << "matches" << '\n';
+    report("log scroll", term, log_scroll, false);
+    report("dashboard", term, dashboard, false);
+    report("full repaint", term, dashboard, true);
+    ox::Terminal::uninitialize();
+}
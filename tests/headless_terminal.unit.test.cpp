@@ -0,0 +1,143 @@
+#include <termox/terminal/headless_terminal.hpp>
+
+#include <string>
+#include <variant>
+
+#include <catch2/catch.hpp>
+
+#include <esc/event.hpp>
+
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/terminal/detail/canvas.hpp>
+#include <termox/terminal/detail/diff_encoder.hpp>
+#include <termox/widget/area.hpp>
+
+namespace {
+
+using Cell_color = ox::Headless_terminal::Cell_color;
+
+}  // namespace
+
+TEST_CASE("Headless_terminal: text and cursor positioning",
+          "[Headless_terminal]")
+{
+    auto term = ox::Headless_terminal{{10, 3}};
+    term.write("ab\033[2;4Hcd\r\ne");
+    CHECK(term.row(0) == U"ab        ");
+    CHECK(term.row(1) == U"   cd     ");
+    CHECK(term.row(2) == U"e         ");
+    CHECK(term.cursor() == ox::Point{1, 2});
+
+    // Writing past the last column does not wrap.
+    term.write("\033[1;9Hxyz");
+    CHECK(term.row(0) == U"ab      xy");
+    CHECK(term.row(1) == U"   cd     ");
+}
+
+TEST_CASE("Headless_terminal: SGR sets colors and attributes",
+          "[Headless_terminal]")
+{
+    auto term = ox::Headless_terminal{{6, 1}};
+    term.write("\033[1;31;48;5;200ma\033[22;38;2;255;0;18mb\033[0mc");
+
+    auto const a = term.at({0, 0});
+    CHECK(a.foreground == Cell_color{Cell_color::Kind::Index, 1});
+    CHECK(a.background == Cell_color{Cell_color::Kind::Index, 200});
+    CHECK(a.attributes == (1 << 1));
+
+    auto const b = term.at({1, 0});
+    CHECK(b.foreground == Cell_color{Cell_color::Kind::RGB, 0xFF0012});
+    CHECK(b.background == Cell_color{Cell_color::Kind::Index, 200});
+    CHECK(b.attributes == 0);
+
+    auto const c = term.at({2, 0});
+    CHECK(c.foreground == Cell_color{});
+    CHECK(c.background == Cell_color{});
+}
+
+TEST_CASE("Headless_terminal: scroll regions, erase and repeat",
+          "[Headless_terminal]")
+{
+    auto term = ox::Headless_terminal{{4, 4}};
+    term.write("0000\r\n1111\r\n2222\r\n3333");
+    term.write("\033[2;3r\033[1S\033[r");
+    CHECK(term.row(0) == U"0000");
+    CHECK(term.row(1) == U"2222");
+    CHECK(term.row(2) == U"    ");
+    CHECK(term.row(3) == U"3333");
+
+    term.write("\033[4;2H\033[K\033[1;2H\033[2X\033[3;1Hz\033[2b");
+    CHECK(term.row(0) == U"0  0");
+    CHECK(term.row(2) == U"zzz ");
+    CHECK(term.row(3) == U"3   ");
+}
+
+TEST_CASE("Headless_terminal: palette redefinition", "[Headless_terminal]")
+{
+    auto term = ox::Headless_terminal{{2, 1}};
+    term.write("\033]4;255;rgb:10/20/30\033\\\033]4;7;rgb:ffff/0/8080\a");
+    CHECK(term.palette_entry(255) == 0x102030u);
+    CHECK(term.palette_entry(7) == 0xFF0080u);
+    CHECK(!term.palette_entry(0).has_value());
+
+    // Queries do not change the palette.
+    term.write("\033]4;0;?\033\\\033]104;255\033\\");
+    CHECK(!term.palette_entry(0).has_value());
+    CHECK(!term.palette_entry(255).has_value());
+    CHECK(term.palette_entry(7) == 0xFF0080u);
+
+    term.write("\033]104\033\\");
+    CHECK(!term.palette_entry(7).has_value());
+}
+
+TEST_CASE("Headless_terminal: sequences split across writes",
+          "[Headless_terminal]")
+{
+    auto term = ox::Headless_terminal{{4, 2}};
+    term.write("\033[");
+    term.write("2;3");
+    term.write("H\xE2\x94");
+    term.write("\x80\033]4;1;rgb:ff/00/00\033");
+    term.write("\\x");
+    CHECK(term.row(1) == U"  ─x");
+    CHECK(term.stats().writes == 5);
+    CHECK(term.stats().bytes == 30);
+}
+
+TEST_CASE("Headless_terminal: displays Diff_encoder output",
+          "[Headless_terminal]")
+{
+    auto canvas = ox::detail::Canvas{{8, 3}};
+    canvas.at({1, 0}) = ox::Glyph{U'a', fg(ox::Color::Red)};
+    canvas.at({2, 0}) = ox::Glyph{U'b'};
+    canvas.at({7, 2}) = ox::Glyph{U'λ', bg(ox::Color::Blue)};
+
+    auto encoder = ox::detail::Diff_encoder{};
+    encoder.set_color_sequences(ox::Color::Red, "\033[31m", "\033[41m");
+    encoder.set_color_sequences(ox::Color::Blue, "\033[34m", "\033[44m");
+    auto diff    = ox::detail::Canvas::Diff{};
+    auto current = ox::detail::Canvas{{8, 3}};
+    merge_and_diff(canvas, current, diff);
+    auto out = std::string{};
+    encoder.encode(diff, out);
+
+    auto term = ox::Headless_terminal{{8, 3}};
+    term.write(out);
+    CHECK(term.row(0) == U" ab     ");
+    CHECK(term.row(1) == U"        ");
+    CHECK(term.row(2) == U"       λ");
+    CHECK(term.at({1, 0}).foreground == Cell_color{Cell_color::Kind::Index, 1});
+    CHECK(term.at({7, 2}).background == Cell_color{Cell_color::Kind::Index, 4});
+}
+
+TEST_CASE("Headless_terminal: scripted input", "[Headless_terminal]")
+{
+    auto term = ox::Headless_terminal{{4, 4}};
+    term.push_input(esc::Window_resize{{4, 4}});
+    term.push_input(esc::Key_press{esc::Key::Enter});
+    CHECK(term.has_input());
+    CHECK(std::holds_alternative<esc::Window_resize>(term.read()));
+    CHECK(std::holds_alternative<esc::Key_press>(term.read()));
+    CHECK(!term.has_input());
+}
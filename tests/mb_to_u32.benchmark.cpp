@@ -0,0 +1,60 @@
+#include <termox/common/mb_to_u32.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Decoding throughput of mb_to_u32() for 8MB of ASCII text, and of text with
+// a multi-byte character every 40 bytes. Compare against memcpy() throughput
+// of the 4x larger output to see how close it is to memory bound.
+
+namespace {
+
+using Clock_t = std::chrono::steady_clock;
+
+auto constexpr size = std::size_t{8} << 20;
+
+auto make_text(std::string const& line) -> std::string
+{
+    auto text = std::string{};
+    text.reserve(size + line.size());
+    while (text.size() < size)
+        text.append(line);
+    return text;
+}
+
+/// Return MB of input decoded per second.
+auto throughput(std::string const& text) -> double
+{
+    auto constexpr iterations = 10;
+    auto chars                = std::size_t{0};
+    auto const start          = Clock_t::now();
+    for (auto i = 0; i < iterations; ++i)
+        chars += ox::mb_to_u32(text).size();
+    auto const elapsed =
+        std::chrono::duration<double>{Clock_t::now() - start}.count();
+    // Keeps the calls from being optimized out.
+    if (chars == 0)
+        std::cout << "";
+    return (double)(text.size() * iterations) / elapsed / 1e6;
+}
+
+}  // namespace
+
+int main()
+{
+    auto const ascii =
+        make_text("The quick brown fox jumps over the lazy dog, 0123456789.\n");
+    auto const mixed =
+        make_text("Schöne Grüße ─ box drawing ─ and an emoji 🌎 now and then\n");
+
+    std::cout << std::left << std::setw(10) << "text" << std::right
+              << std::setw(12) << "MB/s" << '\n';
+    std::cout << std::left << std::setw(10) << "ascii" << std::right
+              << std::setw(12) << std::fixed << std::setprecision(0)
+              << throughput(ascii) << '\n';
+    std::cout << std::left << std::setw(10) << "mixed" << std::right
+              << std::setw(12) << throughput(mixed) << '\n';
+}
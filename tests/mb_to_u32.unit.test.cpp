@@ -0,0 +1,45 @@
+#include <termox/common/mb_to_u32.hpp>
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <termox/common/u32_to_mb.hpp>
+
+TEST_CASE("mb_to_u32: valid UTF-8", "[mb_to_u32]")
+{
+    CHECK(ox::mb_to_u32("").empty());
+    CHECK(ox::mb_to_u32("hello") == U"hello");
+    CHECK(ox::mb_to_u32("hello,ӵ World!🌎~") == U"hello,ӵ World!🌎~");
+    CHECK(ox::mb_to_u32(std::string{"a\0b", 3}) == std::u32string{U"a\0b", 3});
+    CHECK(ox::mb_to_u32("\xF4\x8F\xBF\xBF") == U"\x10FFFF");
+}
+
+TEST_CASE("mb_to_u32: ASCII runs around multi-byte characters",
+          "[mb_to_u32]")
+{
+    // Places the multi-byte character at every offset of a 16 byte block.
+    for (auto i = 0; i < 40; ++i) {
+        auto const expected = std::u32string(i, U'x') + U"─" +
+                              std::u32string(40 - i, U'y');
+        CHECK(ox::mb_to_u32(ox::u32_to_mb(expected)) == expected);
+    }
+}
+
+TEST_CASE("mb_to_u32: invalid sequences become U+FFFD", "[mb_to_u32]")
+{
+    // Stray continuation and invalid lead bytes.
+    CHECK(ox::mb_to_u32("a\x80z") == U"a�z");
+    CHECK(ox::mb_to_u32("\xC0\xAF") == U"��");
+    CHECK(ox::mb_to_u32("\xFF") == U"�");
+
+    // Overlong, surrogate and above U+10FFFF.
+    CHECK(ox::mb_to_u32("\xE0\x80\xAF") == U"���");
+    CHECK(ox::mb_to_u32("\xED\xA0\x80") == U"���");
+    CHECK(ox::mb_to_u32("\xF4\x90\x80\x80") == U"����");
+
+    // Truncated sequences are a single U+FFFD.
+    CHECK(ox::mb_to_u32("\xE2\x94") == U"�");
+    CHECK(ox::mb_to_u32("\xE2\x94z") == U"�z");
+    CHECK(ox::mb_to_u32("\xF0\x9F\x8C") == U"�");
+}
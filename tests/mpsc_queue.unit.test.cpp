@@ -0,0 +1,51 @@
+#include <termox/common/mpsc_queue.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Mpsc_queue: pops in push order", "[Mpsc_queue]")
+{
+    auto queue = ox::Mpsc_queue<std::string>{};
+    CHECK_FALSE(queue.pop().has_value());
+    queue.push("a");
+    queue.push("b");
+    CHECK(queue.pop() == "a");
+    queue.push("c");
+    CHECK(queue.pop() == "b");
+    CHECK(queue.pop() == "c");
+    CHECK_FALSE(queue.pop().has_value());
+    queue.push("left in the queue at destruction");
+}
+
+TEST_CASE("Mpsc_queue: concurrent producers", "[Mpsc_queue]")
+{
+    auto constexpr producers = 4;
+    auto constexpr count     = 10'000;
+    auto queue               = ox::Mpsc_queue<int>{};
+    auto threads             = std::vector<std::thread>{};
+    for (auto p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (auto i = 0; i < count; ++i)
+                queue.push(p * count + i);
+        });
+    }
+
+    // Values from each producer arrive in the order that producer pushed.
+    auto last     = std::vector<int>(producers, -1);
+    auto received = 0;
+    while (received < producers * count) {
+        auto const value = queue.pop();
+        if (!value.has_value())
+            continue;
+        auto const p = *value / count;
+        REQUIRE(*value % count > last[p]);
+        last[p] = *value % count;
+        ++received;
+    }
+    for (auto& t : threads)
+        t.join();
+    CHECK_FALSE(queue.pop().has_value());
+}
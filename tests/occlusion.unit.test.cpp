@@ -0,0 +1,120 @@
+#include <termox/painter/detail/occlusion.hpp>
+
+#include <utility>
+#include <vector>
+
+#include <termox/terminal/detail/canvas.hpp>
+#include <termox/widget/area.hpp>
+#include <termox/widget/layout.hpp>
+#include <termox/widget/point.hpp>
+#include <termox/widget/widget.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+using ox::detail::Canvas;
+
+/// The uncovered spans of rows [top, bottom).
+struct Band {
+    int top;
+    int bottom;
+    std::vector<std::pair<int, int>> spans;
+
+    [[nodiscard]] friend auto operator==(Band const& a, Band const& b) -> bool
+    {
+        return a.top == b.top && a.bottom == b.bottom && a.spans == b.spans;
+    }
+};
+
+/// Place \p w at \p top_left with Area \p area.
+void place(ox::Widget& w, ox::Point top_left, ox::Area area)
+{
+    w.set_top_left(top_left);
+    w.set_area(area);
+}
+
+/// Make \p parent a 10x6 enabled Widget at {2, 1}.
+void setup(ox::layout::Layout<>& parent)
+{
+    place(parent, {2, 1}, {10, 6});
+    parent.enable();
+}
+
+/// Add an enabled child at \p top_left with Area \p area to \p parent.
+auto add(ox::layout::Layout<>& parent, ox::Point top_left, ox::Area area)
+    -> ox::Widget&
+{
+    auto& child = parent.make_child();
+    place(child, top_left, area);
+    child.enable();
+    return child;
+}
+
+/// Return every band of \p w.
+[[nodiscard]] auto sweep(ox::Widget const& w) -> std::vector<Band>
+{
+    auto result = std::vector<Band>{};
+    auto s      = ox::detail::Coverage_sweep{};
+    for (s.reset(w); !s.done(); s.next()) {
+        auto band = Band{s.top(), s.bottom(), {}};
+        for (Canvas::Span span : s.uncovered())
+            band.spans.push_back({span.begin, span.end});
+        result.push_back(band);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Coverage_sweep: partially covered", "[occlusion]")
+{
+    auto parent = ox::layout::Layout<>{};
+    setup(parent);
+    add(parent, {4, 2}, {3, 2});   // Rows [2, 4), x [4, 7).
+    add(parent, {6, 3}, {20, 2});  // Rows [3, 5), x [6, 26), clipped.
+    add(parent, {0, 0}, {1, 20});  // Outside the parent.
+
+    CHECK(sweep(parent) == std::vector<Band>{
+                               {1, 2, {{2, 12}}},
+                               {2, 3, {{2, 4}, {7, 12}}},
+                               {3, 4, {{2, 4}}},
+                               {4, 5, {{2, 6}}},
+                               {5, 7, {{2, 12}}},
+                           });
+    CHECK(!ox::detail::is_hidden(parent));
+}
+
+TEST_CASE("Coverage_sweep: fully tiled", "[occlusion]")
+{
+    auto parent = ox::layout::Layout<>{};
+    setup(parent);
+    add(parent, {2, 1}, {5, 3});
+    add(parent, {7, 1}, {5, 3});
+    add(parent, {2, 4}, {10, 3});
+
+    CHECK(sweep(parent) == std::vector<Band>{{1, 4, {}}, {4, 7, {}}});
+    CHECK(ox::detail::is_hidden(parent));
+
+    // A transparent child does not cover.
+    auto& last = parent.get_children()[2];
+    last.set_wallpaper(U'\0');
+    CHECK(sweep(parent) ==
+          std::vector<Band>{{1, 4, {}}, {4, 7, {{2, 12}}}});
+    CHECK(!ox::detail::is_hidden(parent));
+}
+
+TEST_CASE("Coverage_sweep: gapped", "[occlusion]")
+{
+    auto parent = ox::layout::Layout<>{};
+    setup(parent);
+    add(parent, {2, 1}, {4, 6});
+    add(parent, {7, 1}, {5, 6});
+
+    CHECK(sweep(parent) == std::vector<Band>{{1, 7, {{6, 7}}}});
+    CHECK(!ox::detail::is_hidden(parent));
+
+    // Disabled children do not cover.
+    parent.get_children()[1].disable();
+    CHECK(sweep(parent) == std::vector<Band>{{1, 7, {{6, 12}}}});
+}
@@ -0,0 +1,183 @@
+#include <termox/widget/widget.hpp>
+
+#include <termox/painter/glyph.hpp>
+#include <termox/painter/painter.hpp>
+#include <termox/system/event.hpp>
+#include <termox/system/system.hpp>
+#include <termox/terminal/headless_terminal.hpp>
+#include <termox/terminal/terminal.hpp>
+#include <termox/widget/layout.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+/// Counts the calls to paint_event().
+class Counted : public ox::layout::Layout<> {
+   public:
+    int paints = 0;
+
+   protected:
+    auto paint_event(ox::Painter& p) -> bool override
+    {
+        ++paints;
+        return Layout::paint_event(p);
+    }
+};
+
+/// Puts "ab" at the top left of its wallpaper.
+class Drawn : public ox::Widget {
+   protected:
+    auto paint_event(ox::Painter& p) -> bool override
+    {
+        p.put(ox::Glyph{U'a'}, {0, 0});
+        p.put(ox::Glyph{U'b'}, {1, 0});
+        return Widget::paint_event(p);
+    }
+};
+
+/// Give \p w a position and size and enable it.
+void place(ox::Widget& w, ox::Point top_left, ox::Area area)
+{
+    w.set_top_left(top_left);
+    w.set_area(area);
+    w.enable();
+}
+
+/// Send a Paint_event to \p w and return true if its cache is then valid.
+auto paint(ox::Widget& w) -> bool
+{
+    ox::System::send_event(ox::Paint_event{w});
+    return w.valid_paint_cache() != nullptr;
+}
+
+}  // namespace
+
+TEST_CASE("Paint cache: a hit still emits painted", "[paint cache]")
+{
+    auto term = ox::Headless_terminal{{8, 4}};
+    ox::Terminal::initialize(term);
+    auto w = Counted{};
+    place(w, {0, 0}, {8, 4});
+    w.enable_paint_cache();
+
+    auto emitted = 0;
+    w.painted.connect([&emitted](ox::Painter& p) {
+        ++emitted;
+        p.put(U'*', {1, 1});
+    });
+    CHECK(paint(w));
+    ox::Terminal::screen_buffers.next.at({1, 1}) = ox::Glyph{U'.'};
+    CHECK(paint(w));
+    CHECK(w.paints == 1);
+    CHECK(emitted == 2);
+    CHECK(ox::Terminal::screen_buffers.next.at({1, 1}).symbol == U'*');
+
+    ox::Terminal::uninitialize();
+}
+
+TEST_CASE("Paint cache: cached Glyphs reach the terminal", "[paint cache]")
+{
+    auto term = ox::Headless_terminal{{4, 2}};
+    ox::Terminal::initialize(term);
+    auto w = Drawn{};
+    place(w, {0, 0}, {4, 2});
+    w.set_wallpaper(U'-');
+    w.enable_paint_cache();
+    w.painted.connect([](ox::Painter& p) { p.put(U'*', {3, 1}); });
+
+    // Miss.
+    CHECK(paint(w));
+    ox::Terminal::refresh();
+    CHECK(term.row(0) == U"ab--");
+    CHECK(term.row(1) == U"---*");
+
+    // Hit, over a screen that has changed since.
+    ox::Terminal::screen_buffers.next.at({0, 0}) = ox::Glyph{U'.'};
+    ox::Terminal::screen_buffers.next.at({3, 1}) = ox::Glyph{U'.'};
+    CHECK(paint(w));
+    ox::Terminal::refresh();
+    CHECK(term.row(0) == U"ab--");
+    CHECK(term.row(1) == U"---*");
+
+    ox::Terminal::uninitialize();
+}
+
+TEST_CASE("Paint cache: changes to children invalidate it", "[paint cache]")
+{
+    auto term = ox::Headless_terminal{{8, 4}};
+    ox::Terminal::initialize(term);
+    auto w = Counted{};
+    place(w, {0, 0}, {8, 4});
+    w.enable_paint_cache();
+    CHECK(paint(w));
+
+    SECTION("Add and remove")
+    {
+        auto& child = w.make_child();
+        CHECK(w.valid_paint_cache() == nullptr);
+        place(child, {0, 0}, {2, 2});
+        CHECK(paint(w));
+
+        auto removed = w.remove_child(&child);
+        CHECK(w.valid_paint_cache() == nullptr);
+        CHECK(paint(w));
+        CHECK(w.paints == 3);
+    }
+    SECTION("Move, resize and disable")
+    {
+        auto& child = w.make_child();
+        place(child, {0, 0}, {2, 2});
+        CHECK(paint(w));
+
+        ox::System::send_event(ox::Move_event{child, {3, 1}});
+        CHECK(w.valid_paint_cache() == nullptr);
+        CHECK(paint(w));
+
+        ox::System::send_event(ox::Resize_event{child, {4, 2}});
+        CHECK(w.valid_paint_cache() == nullptr);
+        CHECK(paint(w));
+
+        child.disable();
+        CHECK(w.valid_paint_cache() == nullptr);
+        CHECK(paint(w));
+        CHECK(w.paints == 5);
+    }
+
+    ox::Terminal::uninitialize();
+}
+
+TEST_CASE("Paint cache: update() invalidates only its own Widget",
+          "[paint cache]")
+{
+    auto term = ox::Headless_terminal{{8, 4}};
+    ox::Terminal::initialize(term);
+    auto w = Counted{};
+    place(w, {0, 0}, {8, 4});
+    auto& child = w.make_child<Counted>();
+    place(child, {0, 0}, {4, 2});
+    auto& grandchild = child.make_child();
+    place(grandchild, {0, 0}, {1, 1});
+    w.enable_paint_cache();
+    child.enable_paint_cache();
+    grandchild.enable_paint_cache();
+    CHECK(paint(w));
+    CHECK(paint(child));
+    CHECK(paint(grandchild));
+
+    grandchild.update();
+    CHECK(grandchild.valid_paint_cache() == nullptr);
+    CHECK(child.valid_paint_cache() != nullptr);
+    CHECK(w.valid_paint_cache() != nullptr);
+    CHECK(paint(grandchild));
+
+    // Geometry changes reach the parent only.
+    ox::System::send_event(ox::Move_event{grandchild, {1, 1}});
+    CHECK(grandchild.valid_paint_cache() != nullptr);
+    CHECK(child.valid_paint_cache() == nullptr);
+    CHECK(w.valid_paint_cache() != nullptr);
+    CHECK(w.paints == 1);
+    CHECK(child.paints == 1);
+
+    ox::Terminal::uninitialize();
+}
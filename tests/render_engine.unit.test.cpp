@@ -0,0 +1,69 @@
+#include <termox/system/render_engine.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <termox/painter/glyph.hpp>
+#include <termox/system/event_queue.hpp>
+#include <termox/terminal/headless_terminal.hpp>
+#include <termox/terminal/render_stats.hpp>
+#include <termox/terminal/terminal.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+using Clock_t = ox::Render_engine::Clock_t;
+
+/// Stage \p symbol in the top left cell, as an Event_queue would.
+void paint(char32_t symbol)
+{
+    auto const lock = std::scoped_lock{ox::Event_queue::mutex()};
+    ox::Terminal::screen_buffers.next.at({0, 0}) = ox::Glyph{symbol};
+}
+
+}  // namespace
+
+TEST_CASE("Render_engine: frames are capped and none are lost on stop",
+          "[Render_engine]")
+{
+    auto term = ox::Headless_terminal{{4, 2}};
+    ox::Terminal::initialize(term);
+    auto frames   = std::atomic<int>{0};
+    auto const id = ox::Terminal::frame_rendered.connect(
+        [&frames](ox::Render_stats const&) { ++frames; });
+
+    auto constexpr interval = std::chrono::milliseconds{20};
+    auto engine             = ox::Render_engine{};
+    engine.set_interval(interval);
+    engine.start();
+
+    // Requests are made far faster than the cap allows.
+    auto requests    = 0;
+    auto const start = Clock_t::now();
+    while (Clock_t::now() - start < interval * 10) {
+        paint(U'a' + requests++ % 26);
+        engine.request_present();
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+    }
+    auto const elapsed = Clock_t::now() - start;
+    auto const capped  = frames.load();
+    CHECK(capped >= 2);
+    CHECK(capped <= (elapsed / interval) + 1);
+    CHECK(requests > capped * 10);
+
+    // The last request is waiting out the interval when stop() is called.
+    engine.set_interval(std::chrono::hours{1});
+    std::this_thread::sleep_for(interval);
+    auto const before = frames.load();
+    paint(U'#');
+    engine.request_present();
+    engine.stop();
+    CHECK(frames.load() == before + 1);
+    CHECK(term.at({0, 0}).symbol == U'#');
+
+    ox::Terminal::frame_rendered.disconnect(id);
+    ox::Terminal::uninitialize();
+}
@@ -0,0 +1,59 @@
+#include <termox/common/seqlock.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+/// Every member holds the same value if the copy was not torn.
+struct Wide {
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    std::uint32_t c = 0;
+    std::uint64_t d = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Seqlock: load returns the last stored value", "[Seqlock]")
+{
+    auto lock = ox::Seqlock<Wide>{};
+    CHECK(lock.load().a == 0);
+    lock.store({1, 2, 3, 4});
+    auto const x = lock.load();
+    CHECK(x.a == 1);
+    CHECK(x.b == 2);
+    CHECK(x.c == 3);
+    CHECK(x.d == 4);
+}
+
+TEST_CASE("Seqlock: concurrent loads are never torn", "[Seqlock]")
+{
+    auto lock = ox::Seqlock<Wide>{};
+    auto done = std::atomic<bool>{false};
+
+    auto writer = std::thread{[&] {
+        for (auto i = std::uint32_t{1}; i <= 200'000; ++i)
+            lock.store({i, i, i, i});
+        done = true;
+    }};
+
+    auto torn = 0;
+    auto last = std::uint64_t{0};
+    auto ordered = true;
+    while (!done) {
+        auto const x = lock.load();
+        if (x.a != x.b || x.a != x.c || x.a != x.d)
+            ++torn;
+        if (x.a < last)
+            ordered = false;
+        last = x.a;
+    }
+    writer.join();
+    CHECK(torn == 0);
+    CHECK(ordered);
+    CHECK(lock.load().d == 200'000);
+}
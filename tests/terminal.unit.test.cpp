@@ -0,0 +1,119 @@
+#include <termox/terminal/terminal.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+#include <termox/painter/color.hpp>
+#include <termox/painter/glyph.hpp>
+#include <termox/painter/palette/dawn_bringer16.hpp>
+#include <termox/terminal/headless_terminal.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+using Cell_color = ox::Headless_terminal::Cell_color;
+
+/// A Dynamic_color fixed at \p value, with an interval that never elapses.
+[[nodiscard]] auto fixed(std::uint32_t value) -> ox::Dynamic_color
+{
+    return {std::chrono::hours{1},
+            [value] { return ox::True_color{ox::RGB{value}}; }};
+}
+
+/// Paint a Glyph with foreground \p c to the top left cell and refresh.
+void paint(ox::Color c)
+{
+    ox::Terminal::screen_buffers.next.at({0, 0}) = ox::Glyph{U'x', fg(c)};
+    ox::Terminal::refresh();
+}
+
+}  // namespace
+
+TEST_CASE("Terminal: Dynamic_colors take free palette slots from the top",
+          "[Terminal]")
+{
+    auto term = ox::Headless_terminal{{2, 1}};
+    ox::Terminal::initialize(term);
+
+    // Entries 254 and 255 are the only ones the palette leaves free.
+    auto palette = ox::Palette{};
+    for (auto i = 0; i < 254; ++i) {
+        palette.push_back(
+            {ox::Color{static_cast<ox::Color::Value_t>(i)},
+             ox::Color_index{static_cast<ox::Color::Value_t>(i)}});
+    }
+    palette.push_back({ox::Color{254}, fixed(0x102030)});
+    palette.push_back({ox::Color{255}, fixed(0x405060)});
+    ox::Terminal::set_palette(palette);
+    CHECK(term.palette_entry(255) == 0x102030u);
+    CHECK(term.palette_entry(254) == 0x405060u);
+    CHECK(!term.palette_entry(253).has_value());
+
+    paint(ox::Color{255});
+    CHECK(term.at({0, 0}).foreground ==
+          Cell_color{Cell_color::Kind::Index, 254});
+
+    ox::Terminal::set_palette(ox::dawn_bringer16::palette);
+    ox::Terminal::uninitialize();
+    ox::Terminal::stop_dynamic_color_engine();
+}
+
+TEST_CASE("Terminal: Dynamic_colors fall back when every slot is taken",
+          "[Terminal]")
+{
+    auto term = ox::Headless_terminal{{2, 1}};
+    ox::Terminal::initialize(term);
+
+    // Every palette entry is in use, the last definition of Color 0 wins.
+    auto palette = ox::Palette{};
+    for (auto i = 0; i < 256; ++i) {
+        palette.push_back(
+            {ox::Color{static_cast<ox::Color::Value_t>(i)},
+             ox::Color_index{static_cast<ox::Color::Value_t>(i)}});
+    }
+    palette.push_back({ox::Color{0}, fixed(0x102030)});
+    ox::Terminal::set_palette(palette);
+    for (auto i = 0; i < 256; ++i)
+        CHECK(!term.palette_entry(i).has_value());
+
+    paint(ox::Color{0});
+    CHECK(term.at({0, 0}).foreground ==
+          Cell_color{Cell_color::Kind::RGB, 0x102030});
+
+    ox::Terminal::set_palette(ox::dawn_bringer16::palette);
+    ox::Terminal::uninitialize();
+    ox::Terminal::stop_dynamic_color_engine();
+}
+
+TEST_CASE("Terminal: palette slots are freed and reused", "[Terminal]")
+{
+    auto term = ox::Headless_terminal{{2, 1}};
+    ox::Terminal::initialize(term);
+
+    ox::Terminal::set_palette(
+        {{ox::Color{0}, ox::Color_index{0}}, {ox::Color{1}, fixed(0x102030)}});
+    CHECK(term.palette_entry(255) == 0x102030u);
+
+    // A new palette releases the old slot before taking one.
+    ox::Terminal::set_palette(
+        {{ox::Color{0}, ox::Color_index{0}}, {ox::Color{2}, fixed(0x405060)}});
+    CHECK(term.palette_entry(255) == 0x405060u);
+    CHECK(!term.palette_entry(254).has_value());
+
+    paint(ox::Color{2});
+    CHECK(term.at({0, 0}).foreground ==
+          Cell_color{Cell_color::Kind::Index, 255});
+
+    ox::Terminal::set_palette(ox::dawn_bringer16::palette);
+    CHECK(!term.palette_entry(255).has_value());
+
+    ox::Terminal::set_palette(
+        {{ox::Color{0}, ox::Color_index{0}}, {ox::Color{1}, fixed(0x708090)}});
+    CHECK(term.palette_entry(255) == 0x708090u);
+
+    // Teardown gives every reserved entry back to the terminal.
+    ox::Terminal::uninitialize();
+    CHECK(!term.palette_entry(255).has_value());
+    ox::Terminal::stop_dynamic_color_engine();
+}
@@ -0,0 +1,29 @@
+#include <termox/common/thread_pool.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Thread_pool: every index runs exactly once", "[Thread_pool]")
+{
+    for (auto workers : {0, 1, 3}) {
+        auto pool = ox::Thread_pool{static_cast<std::size_t>(workers)};
+        CHECK(pool.worker_count() == static_cast<std::size_t>(workers));
+        for (auto batch = 0; batch < 50; ++batch) {
+            auto counts = std::vector<std::atomic<int>>(97);
+            pool.run(counts.size(), [&](std::size_t i) { ++counts[i]; });
+            for (auto const& count : counts)
+                REQUIRE(count.load() == 1);
+        }
+    }
+}
+
+TEST_CASE("Thread_pool: empty batches return immediately", "[Thread_pool]")
+{
+    auto pool  = ox::Thread_pool{2};
+    auto calls = std::atomic<int>{0};
+    pool.run(0, [&](std::size_t) { ++calls; });
+    CHECK(calls == 0);
+}
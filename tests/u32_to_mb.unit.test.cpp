@@ -0,0 +1,44 @@
+#include <termox/common/u32_to_mb.hpp>
+
+#include <array>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("u32_to_utf8: every encoded length", "[u32_to_mb]")
+{
+    auto buffer = std::array<char, 4>{};
+    auto encode = [&](char32_t c) {
+        auto const count = ox::u32_to_utf8(c, buffer.data());
+        CHECK(count == ox::utf8_length(c));
+        return std::string(buffer.data(), count);
+    };
+    CHECK(encode(U'a') == "a");
+    CHECK(encode(U'\x7F') == "\x7F");
+    CHECK(encode(U'ӵ') == "\xD3\xB5");
+    CHECK(encode(U'\x7FF') == "\xDF\xBF");
+    CHECK(encode(U'─') == "\xE2\x94\x80");
+    CHECK(encode(U'\xFFFF') == "\xEF\xBF\xBF");
+    CHECK(encode(U'🌎') == "\xF0\x9F\x8C\x8E");
+    CHECK(encode(U'\x10FFFF') == "\xF4\x8F\xBF\xBF");
+}
+
+TEST_CASE("u32_to_utf8: invalid code points", "[u32_to_mb]")
+{
+    auto buffer = std::array<char, 4>{};
+    for (auto c : {char32_t{0xD800}, char32_t{0xDFFF}, char32_t{0x110000}}) {
+        auto const count = ox::u32_to_utf8(c, buffer.data());
+        CHECK(std::string(buffer.data(), count) == "\xEF\xBF\xBD");
+    }
+}
+
+TEST_CASE("u32_to_mb: strings", "[u32_to_mb]")
+{
+    CHECK(ox::u32_to_mb(U"").empty());
+    CHECK(ox::u32_to_mb(U"hello") == "hello");
+    CHECK(ox::u32_to_mb(U"ab─🌎c") == "ab\xE2\x94\x80\xF0\x9F\x8C\x8E" "c");
+
+    auto out = std::string{"x"};
+    ox::append_utf8(U"yӵ", out);
+    CHECK(out == "xy\xD3\xB5");
+}